@@ -9,15 +9,13 @@
 #include "sortnet/z_environment.h"
 
 namespace sortnet {
-template <concepts::Set Set, concepts::ComparatorNetwork Net, uint64_t size> class BufferSet {
+template <concepts::Set Set, uint64_t size> class BufferSet {
 public:
   std::vector<Set> sets{};
-  std::vector<Net> nets{};
 
-  constexpr BufferSet() : sets(size), nets(size) {}
+  constexpr BufferSet() : sets(size) {}
 };
 
-template <concepts::Set Set, concepts::ComparatorNetwork Net, uint8_t NrOfCores,
-          uint64_t bufferSize>
-class BufferPool : public Pool<BufferSet<Set, Net, bufferSize>> {};
+template <concepts::Set Set, uint8_t NrOfCores, uint64_t bufferSize>
+class BufferPool : public Pool<BufferSet<Set, bufferSize>> {};
 }  // namespace sortnet
\ No newline at end of file
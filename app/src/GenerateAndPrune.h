@@ -3,45 +3,104 @@
 #include <sortnet/concepts.h>
 #include <sortnet/json.h>
 #include <sortnet/metric.h>
+#include <sortnet/networks/Network.h>
 #include <sortnet/permutation.h>
+#include <sortnet/segment.h>
+#include <sortnet/util.h>
 #include <sortnet/comparator.h>
 #include <sortnet/z_environment.h>
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <bit>
 #include <chrono>
+#include <exception>
+#include <functional>
 #include <future>
 #include <iostream>
+#include <iterator>
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
 #include <tabulate/table.hpp>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "BufferPool.h"
+#include "WorkStealingPool.h"
+#include "WriteBehind.h"
 #include "progress.h"
 #include "sortnet/sequence.h"
-#include "vendors/github.com/dabbertorres/ThreadPool/ThreadPool.h"
 
 struct NetAndSetFilename {
   const std::string net;
   const std::string set;
 };
 
+// Net is the network record written to the n*.gnp files, either a complete
+// network::Network or a network::Link that only holds the last comparator.
 template <uint8_t N, uint8_t K, uint8_t NrOfCores, ::sortnet::concepts::Set Set,
-          ::sortnet::concepts::ComparatorNetwork Net, typename Storage>
+          ::sortnet::concepts::NetworkRecord Net, typename Storage>
 class GenerateAndPrune {
 private:
+  using Network = ::sortnet::network::Network<N, K>;
+
+  // a network file along with the range of ids it holds, see rebuild
+  struct NetworkFile {
+    uint64_t first;
+    uint64_t last;
+    std::string net;
+  };
+
+  // the number of sets in a segment by some key of theirs, see redistribute
+  using Histogram = std::vector<uint64_t>;
+
+  // the keys of sortBySize, a set holds between 0 and 2^N sequences
+  static constexpr std::size_t SizeKeys{(std::size_t(1) << N) + 1};
+
   static const auto FileLimit{::sortnet::segment_capacity * 2};  // ugly
   std::vector<NetAndSetFilename> filenames{};
+  std::vector<std::vector<NetworkFile>> networkFiles{};
   Storage storage{};
 
-  ::sortnet::BufferPool<Set, Net, NrOfCores, ::sortnet::segment_capacity> buffers{};
+  // the sizes of the sets in every segment, counted by pruneWithinFiles so
+  // that sortBySize does not have to read the layer once more
+  std::vector<Histogram> setSizes{};
+
+  // the storage can hand out read-only views of segments, see MappedStorage
+  // and MemoryStorage
+  static constexpr bool MappedSegments{
+      requires(Storage& s, const std::string& filename) { s.template Map<Set>(filename); }};
+
+  // the storage can read many segments in one batch, see UringStorage
+  using Request = ::sortnet::segment::Request<typename std::vector<Set>::iterator>;
+  static constexpr bool BatchedLoads{requires(Storage& s, std::span<Request> requests,
+                                              uint8_t layer) { s.Load(requests, layer); }};
+
+  using Buffers = ::sortnet::BufferPool<Set, NrOfCores, ::sortnet::segment_capacity>;
+  using Buffer = ::sortnet::BufferSet<Set, ::sortnet::segment_capacity>;
+  Buffers buffers{};
+
+  // segments per tile in pruneAcrossFiles, such that three tiles fit in the
+  // memory budget: the primary tile, the secondary tile and the next secondary
+  // tile that is loaded meanwhile. Sets that keep their sequences on the heap
+  // are counted by their size only.
+  static constexpr std::size_t TileSize{std::max<std::size_t>(
+      1, ::sortnet::prune_memory_budget / (3 * sizeof(Set) * ::sortnet::segment_capacity))};
+
+  ::sortnet::WriteBehind<Storage, Buffers, Buffer> writer{
+      storage, buffers, ::sortnet::write_behind_threads, ::sortnet::write_behind_capacity};
 
   ::sortnet::MetricsLayered<N, K> metrics{};
   ::sortnet::MetricLayer* metric = &metrics.at(0);
 
-  ::dbr::cc::ThreadPool pool;
+  ::sortnet::WorkStealingPool pool;
 
   constexpr void storeEmptyNetworkWithOutputSet() {
     // we store an empty network and a complete output set
@@ -78,6 +137,57 @@ private:
         .net{netFile},
         .set{setFile},
     });
+    networkFiles.push_back({NetworkFile{net.id, net.id, netFile}});
+  }
+
+  // networks are saved in the order they are generated, which gives every
+  // network file ascending ids. Returns end when the id is not present.
+  template <typename iterator>
+  static iterator findNetwork(const uint64_t id, const iterator begin, const iterator end) {
+    const auto it = std::lower_bound(begin, end, id,
+                                     [](const Net& net, const uint64_t v) { return net.id < v; });
+    return (it != end && it->id == id) ? it : end;
+  }
+
+  // the complete network of a record in the given layer. A Link record is
+  // followed back through the network files of the earlier layers, where only
+  // the files whose id range covers the parent are searched.
+  Network rebuild(const Net& record, uint8_t layer) {
+    if constexpr (std::is_same_v<Net, Network>) {
+      return record;
+    } else {
+      std::vector<Net> nets(::sortnet::segment_capacity);
+      std::vector<::sortnet::Comparator> comparators{};
+      Net current{record};
+      for (; layer > 0; --layer) {
+        comparators.push_back(current.back());
+
+        const uint64_t parent{current.parent};
+        bool found{false};
+        for (const auto& file : networkFiles.at(layer - 1)) {
+          if (parent < file.first || parent > file.last) {
+            continue;
+          }
+          const auto size = storage.Load(file.net, layer - 1, nets.begin(), nets.end());
+          const auto it = findNetwork(parent, nets.cbegin(), nets.cbegin() + size);
+          if (it != nets.cbegin() + size) {
+            current = *it;
+            found = true;
+            break;
+          }
+        }
+        if (!found) {
+          throw std::logic_error("the parent network was not found in the previous layer");
+        }
+      }
+
+      Network network{};
+      for (auto it{comparators.crbegin()}; it != comparators.crend(); ++it) {
+        network.push_back(*it);
+      }
+      network.id = record.id;
+      return network;
+    }
   }
 
   // group together the unmarked sets
@@ -103,7 +213,19 @@ private:
     return counter;
   }
 
-  constexpr bool subsumesByPermutation(const Set& setA, const Set& setB) const {
+  // try the identity and the permutations that recently caused a subsumption
+  // on this thread, before searching for a permutation from scratch.
+  bool subsumesByPermutation(const Set& setA, const Set& setB) const {
+    using Recent = ::sortnet::permutation::Recent<N, ::sortnet::permutation_cache_capacity>;
+    static thread_local Recent recent{};
+
+    if (setA.subsumes(setB)) {
+#if (RECORD_INTERNAL_METRICS == 1)
+      metric->IdentitySubsumptions++;
+#endif
+      return true;
+    }
+
 #if (RECORD_INTERNAL_METRICS == 1)
     metric->ST4Calls++;
 #endif
@@ -116,16 +238,59 @@ private:
     }
 #if (RECORD_INTERNAL_METRICS == 1)
     metric->ST4++;
+#endif
+
+    // cached permutations that violate the constraints can not be a witness
+    if (recent.find([&](const ::sortnet::permutation::permutation_t<N>& p) {
+          return ::sortnet::permutation::allowed<N>(constraints, p)
+                 && ::sortnet::permutation::subsumes<N>(p, setA, setB);
+        })) {
+#if (RECORD_INTERNAL_METRICS == 1)
+      metric->PermutationCacheHits++;
+#endif
+      return true;
+    }
+#if (RECORD_INTERNAL_METRICS == 1)
+    metric->PermutationCacheMisses++;
+    metric->ST5Calls++;
+#endif
+    if (!::sortnet::permutation::propagate<N>(constraints)
+        || !::sortnet::permutation::matching<N>(constraints)) {
+      return false;
+    }
+#if (RECORD_INTERNAL_METRICS == 1)
+    metric->ST5++;
     metric->PermutationGeneratorCalls++;
 #endif
 
-    return ::sortnet::permutation::generate<N>(
-        constraints, [&](const ::sortnet::permutation::permutation_t<N>& p) {
+    // bitmaps can be permuted and compared as a whole, which pays off for the
+    // large output sets of the first layers. Smaller sets are rejected faster
+    // sequence by sequence while the permutation is being built.
+    if constexpr (::sortnet::concepts::WordSet<Set>) {
+      constexpr std::size_t wordParallelMinSize{(std::size_t(1) << N) / 5};
+      if (setA.size() >= wordParallelMinSize) {
+        return ::sortnet::permutation::generate<N>(constraints, [&](const auto& p) {
+          if (!::sortnet::permutation::subsumes<N>(p, setA, setB)) {
+            return false;
+          }
 #if (RECORD_INTERNAL_METRICS == 1)
           metric->Permutations++;
 #endif
-          return ::sortnet::permutation::subsumes<N>(p, setA, setB);
+          recent.add(p);
+          return true;
         });
+      }
+    }
+
+    // sequences are tested while the permutation is being built, so any
+    // complete permutation is a witness
+    return ::sortnet::permutation::subsumes<N>(constraints, setA, setB, [&](const auto& p) {
+#if (RECORD_INTERNAL_METRICS == 1)
+      metric->Permutations++;
+#endif
+      recent.add(p);
+      return true;
+    });
   }
 
   constexpr bool permutationConditions(const Set& setA, const Set& setB) const {
@@ -137,6 +302,14 @@ private:
     }
 #if (RECORD_INTERNAL_METRICS == 1)
     metric->ST1++;
+#endif
+    return sizeConditions(setA, setB);
+  }
+
+  // the conditions of permutationConditions that follow ST1, for sets that
+  // are known to pass ST1
+  constexpr bool sizeConditions(const Set& setA, const Set& setB) const {
+#if (RECORD_INTERNAL_METRICS == 1)
     metric->ST2Calls++;
 #endif
     if (!::sortnet::permutation::ST2(setA, setB)) {
@@ -157,8 +330,9 @@ private:
   }
 
   // compare two sets and check if they can be subsumed by a permutation
-  // return true if the first set is marked (allowing fail fast)
-  constexpr bool marked(Set& setA, Set& setB) const {
+  // return true if the first set is marked (allowing fail fast). Whether setB
+  // subsumes setA is only tested if backward is set.
+  constexpr bool marked(Set& setA, Set& setB, const bool backward = true) const {
     if (permutationConditions(setA, setB) && subsumesByPermutation(setA, setB)) {
 #if (RECORD_INTERNAL_METRICS == 1)
       metric->Subsumptions++;
@@ -170,6 +344,9 @@ private:
       metric->HasNoPermutation++;
 #endif
     }
+    if (!backward) {
+      return false;
+    }
 
     if (permutationConditions(setB, setA) && subsumesByPermutation(setB, setA)) {
 #if (RECORD_INTERNAL_METRICS == 1)
@@ -185,7 +362,26 @@ private:
     return false;
   }
 
-  // mark redundant sets within a file
+  // orders sets by size and then by their sizes metadata, which is the order
+  // markRedundantNetworks expects within a file. Ties are broken by network
+  // id to keep the order deterministic.
+  template <typename II> static void orderBySize(const II begin, const II end) {
+    std::sort(begin, end, [](const Set& a, const Set& b) {
+      if (a.size() != b.size()) {
+        return a.size() < b.size();
+      }
+      if (a.metadata.sizes != b.metadata.sizes) {
+        return a.metadata.sizes < b.metadata.sizes;
+      }
+      return a.metadata.netID < b.metadata.netID;
+    });
+  }
+
+  // mark redundant sets within a file, which must be ordered by orderBySize.
+  // A set can only subsume sets that are at least as large (ST1), so a set is
+  // only tested in both directions against the run of sets of equal size that
+  // follows it, and in one direction against every larger set. ST1 itself is
+  // never tested.
   template <typename II> constexpr void markRedundantNetworks(II it, const II end) const {
     for (; it != end; ++it) {
       Set& setA{*it};
@@ -193,52 +389,88 @@ private:
         continue;
       }
 
-      for (auto it2{it + 1}; it2 != end; ++it2) {
+      const auto size{setA.size()};
+      const auto larger{
+          std::partition_point(it + 1, end, [&](const Set& set) { return set.size() == size; })};
+      bool subsumed{false};
+      for (auto it2{it + 1}; it2 != larger && !subsumed; ++it2) {
         Set& setB{*it2};
         if (setB.metadata.marked) {
           continue;
         }
-
-        if (marked(setA, setB)) {
-          break;
+        subsumed = markedBySize(setA, setB, true);
+      }
+      for (auto it2{larger}; it2 != end && !subsumed; ++it2) {
+        Set& setB{*it2};
+        if (setB.metadata.marked) {
+          continue;
         }
+        markedBySize(setA, setB, false);
       }
     }
   }
 
-  // mark redundant sets across two files
-  template <typename II, typename IIMut>
-  constexpr void markRedundantNetworks(const II begin1, const II end1, const IIMut begin2,
-                                       const IIMut end2) const {
+  // marked() for sets that pass ST1, where setB can only subsume setA when
+  // they are of equal size. Returns true if setA is marked.
+  constexpr bool markedBySize(Set& setA, Set& setB, const bool equal) const {
+    if (sizeConditions(setA, setB) && subsumesByPermutation(setA, setB)) {
+#if (RECORD_INTERNAL_METRICS == 1)
+      metric->ST1Avoided++;
+      metric->Subsumptions++;
+#endif
+      setB.metadata.marked = true;
+      return false;
+    }
+#if (RECORD_INTERNAL_METRICS == 1)
+    metric->ST1Avoided += 2;
+    metric->HasNoPermutation++;
+#endif
+    if (!equal) {
+      return false;
+    }
+
+    if (sizeConditions(setB, setA) && subsumesByPermutation(setB, setA)) {
+#if (RECORD_INTERNAL_METRICS == 1)
+      metric->Subsumptions++;
+#endif
+      setA.metadata.marked = true;
+      return true;
+    }
+#if (RECORD_INTERNAL_METRICS == 1)
+    metric->HasNoPermutation++;
+#endif
+    return false;
+  }
+
+  // mark redundant sets across two files, in either direction. Whether sets
+  // of the second file subsume sets of the first is only tested if backward
+  // is set.
+  template <typename II>
+  constexpr void markRedundantNetworks(const II begin1, const II end1, const II begin2,
+                                       const II end2, const bool backward = true) const {
     for (II it1{begin1}; it1 != end1; ++it1) {
-      const Set& setA{*it1};
+      Set& setA{*it1};
       if (setA.metadata.marked) {
         continue;
       }
 
-      for (IIMut it2{begin2}; it2 != end2; ++it2) {
+      for (II it2{begin2}; it2 != end2; ++it2) {
         Set& setB{*it2};
         if (setB.metadata.marked) {
           continue;
         }
 
-        if (!(permutationConditions(setA, setB) && subsumesByPermutation(setA, setB))) {
-#if (RECORD_INTERNAL_METRICS == 1)
-          metric->HasNoPermutation++;
-#endif
-          continue;
+        if (marked(setA, setB, backward)) {
+          break;
         }
-
-#if (RECORD_INTERNAL_METRICS == 1)
-        metric->Subsumptions++;
-#endif
-        setB.metadata.marked = true;
       }
     }
   }
 
 public:
-  GenerateAndPrune() : pool(NrOfCores) {}
+  // the calling thread runs jobs too while it waits on the pool, see
+  // WorkStealingPool::get
+  GenerateAndPrune() : pool(std::max(NrOfCores, uint8_t{2}) - 1) {}
   ::sortnet::MetricsLayered<N, K> run() {
     metric = &metrics.at(0);
 
@@ -308,7 +540,20 @@ public:
 #if (RECORD_INTERNAL_METRICS == 1)
         const auto start = now();
 #endif
+#if (SORT_LAYERS_BY_SIZE == 1)
+        // siblings are most alike, so the layer is only sorted once the files
+        // they were generated in have been pruned, and put back in the order
+        // it was generated in before the next layer is generated
+        sortBySize(layer);
         pruned += pruneAcrossFiles(layer);
+        // a layer that fits in one segment has no segments to put back in
+        // the order they were generated in
+        if (filenames.size() > 1) {
+          sortByOrigin(layer);
+        }
+#else
+        pruned += pruneAcrossFiles(layer);
+#endif
 #if (RECORD_INTERNAL_METRICS == 1)
         const auto end = now();
         const auto d = duration(start, end);
@@ -323,6 +568,11 @@ public:
       // always record the nr of pruned and generated networks
       metric->Generated = generated;
       metric->Pruned += pruned;
+#if (RECORD_INTERNAL_METRICS == 1)
+      if constexpr (requires { storage.record(*metric); }) {
+        storage.record(*metric);
+      }
+#endif
 
 #if (RECORD_IO_TIME == 1)
       const auto fileIODuration = nanosecondsToSeconds(storage.duration);
@@ -351,9 +601,13 @@ public:
     }
 
     if (metric->filters() == 1) {
-      std::vector<Net> nets(1);
-      storage.Load(filenames.front().net, layer, nets.begin(), nets.end());
-      const Net& sortingNetwork = nets.at(0);
+      // pruning only rewrites the set files, so the network is found through the
+      // id of the remaining set
+      Net record{};
+      for (const auto& file : filenames) {
+        this->read(file, layer, [&](const Net& net, const Set&) { record = net; });
+      }
+      const Network sortingNetwork{rebuild(record, layer)};
 
       ::sortnet::sequence_t s = ::sortnet::sequence::binary::mask<N> & 0b1011010110101011101011;
 
@@ -361,6 +615,8 @@ public:
       std::cout << "======== FOUND SORTING NETWORK FOR N(" + std::to_string(N) + ") ===========================================================";
       std::cout << std::endl;
       std::cout << "total time: " << metrics.Seconds() << "s" << std::endl;
+      std::cout << "sorts all " << (std::size_t(1) << N) << " binary inputs: "
+                << (sortingNetwork.sorts() ? "yes" : "no") << std::endl;
 
       std::cout << std::endl;
 
@@ -399,121 +655,390 @@ public:
     return metrics;
   }
 
+  // calls _f for every set along with its network. Pruning keeps the order
+  // of the sets, so each search starts at the network of the previous set.
+  template <typename NetIt, typename SetIt, typename Functor>
+  static void join(const NetIt nets, const NetIt end, SetIt it, const SetIt setsEnd, Functor& _f) {
+    auto hint{nets};
+    for (; it != setsEnd; ++it) {
+      const auto netID{it->metadata.netID};
+      hint = findNetwork(netID, hint != end && hint->id <= netID ? hint : nets, end);
+      if (hint == end) {
+        throw std::logic_error("no network was found for the given network id");
+      }
+      _f(*hint, *it);
+    }
+  }
+
   template <typename Functor>
   uint64_t read(const NetAndSetFilename& file, uint8_t layer, Functor _f) {
-    constexpr uint32_t FileSize{::sortnet::segment_capacity};
-
-    std::vector<Set> sets(FileSize);
-    std::vector<Net> nets(FileSize);
-
-    auto find = [](const uint64_t netID, auto it, const auto end) -> Net {
-      for (; it != end; ++it) {
-        if (it->id == netID) {
-          return static_cast<Net>(*it);
-        }
-      }
+    if constexpr (MappedSegments) {
+      const auto nets = storage.template Map<Net>(file.net);
+      const auto sets = storage.template Map<Set>(file.set);
+#if (RECORD_INTERNAL_METRICS == 1)
+      metric->FileRead += 2;
+#endif
+      join(nets.begin(), nets.end(), sets.begin(), sets.end(), _f);
+      return sets.size();
+    } else {
+      constexpr uint32_t FileSize{::sortnet::segment_capacity};
 
-      throw std::logic_error("no network was not found for the given network id");
-    };
+      std::vector<Set> sets(FileSize);
+      std::vector<Net> nets(FileSize);
 
-    const auto nrOfNets = storage.Load(file.net, layer, nets.begin(), nets.end());
-    const auto nrOfSets = storage.Load(file.set, layer, sets.begin(), sets.end());
+      const auto nrOfNets = storage.Load(file.net, layer, nets.begin(), nets.end());
+      const auto nrOfSets = storage.Load(file.set, layer, sets.begin(), sets.end());
 #if (RECORD_INTERNAL_METRICS == 1)
-    metric->FileRead += 2;
+      metric->FileRead += 2;
 #endif
-    sets.resize(nrOfSets);
-
-    for (const auto& set : sets) {
-      const auto netID{set.metadata.netID};
-      const Net& net = find(netID, nets.begin(), nets.begin() + nrOfNets);
-      _f(net, set);
+      join(nets.cbegin(), nets.cbegin() + nrOfNets, sets.cbegin(), sets.cbegin() + nrOfSets, _f);
+      return nrOfSets;  // nrOfNets contains pruned entities
     }
-
-    return nrOfSets;  // nrOfNets contains pruned entities
   }
 
+  // the output of generating from one input segment, where the last segment
+  // holds tail networks when it is not full
+  struct Expansion {
+    std::vector<NetAndSetFilename> files{};
+    std::vector<NetworkFile> networks{};
+    uint64_t tail{0};
+    uint64_t generated{0};
+    uint64_t redundant{0};
+    uint64_t redundantQuick{0};
+  };
+
+  // every input segment is expanded by its own task. Output segment j of input
+  // segment i is saved under the sequence number i * Chunks + j, and network
+  // IDs are prefixed by i, such that both are unique and do not depend on the
+  // order in which the tasks are scheduled. The partial last segments of the
+  // tasks are merged into full ones in input order, numbered after those.
   uint64_t generate(uint8_t layer) {
+    // an input segment holds at most segment_capacity networks, each of which
+    // produces at most one child per comparator
+    constexpr uint64_t Chunks{::sortnet::comparator::size<N>()};
+
     const auto existingFiles = std::move(filenames);
     filenames.clear();  // TODO: redundant?
 
-    auto save = [&](auto itNets, const auto endNets, auto itSets, const auto endSets) -> void {
-      const auto netFile = storage.Save(layer, itNets, endNets);
-      const auto setFile = storage.Save(layer, itSets, endSets);
-#if (RECORD_INTERNAL_METRICS == 1)
-      metric->FileWrite += 2;
-#endif
-
-      filenames.emplace_back(NetAndSetFilename{
-          .net{netFile},
-          .set{setFile},
-      });
-    };
-
 #if (PRINT_PROGRESS == 1)
+    std::mutex m;
     uint64_t filters = metrics.at(layer - 1).filters();
     Progress bar("generating", "files", filters);
     bar.display();
 #endif
 
-    std::vector<Net> nets(::sortnet::segment_capacity);
-    std::vector<Set> sets(::sortnet::segment_capacity);
-
-    uint64_t counter{0};
-    uint64_t idCounter{0};
-    Set setBuffer{};
-    for (const auto& file : existingFiles) {
-      auto nrOfNetworks = this->read(file, layer - 1, [&](const Net& net, const Set& set) {
+    auto expand = [&, layer](const std::size_t segment) -> Expansion {
+      auto* buffer = buffers.get();
+      auto& sets{buffer->sets};
+      std::vector<Net> nets(::sortnet::segment_capacity);
+
+      Expansion expansion{};
+      uint64_t counter{0};
+      uint64_t chunk{0};
+      auto save = [&]() -> void {
+        const auto snr{segment * Chunks + chunk++};
+        const auto netFile = storage.Save(storage.folder() + storage.filenameNetworks(layer, snr),
+                                          layer, nets.cbegin(), nets.cbegin() + counter);
+        const auto setFile = storage.Save(storage.folder() + storage.filenameSets(layer, snr),
+                                          layer, sets.cbegin(), sets.cbegin() + counter);
+        expansion.files.emplace_back(NetAndSetFilename{
+            .net{netFile},
+            .set{setFile},
+        });
+        expansion.networks.push_back(
+            NetworkFile{nets.front().id, nets.at(counter - 1).id, netFile});
+        expansion.tail = counter < ::sortnet::segment_capacity ? counter : 0;
+        counter = 0;
+      };
+
+      Set setBuffer{};
+      const auto& file{existingFiles[segment]};
+      [[maybe_unused]] const auto nrOfNetworks = this->read(file, layer - 1, [&](const Net& net,
+                                                                                const Set& set) {
         for (const ::sortnet::Comparator& c : ::sortnet::comparator::all<N>) {
           if (net.back() == c) {
-#if (RECORD_INTERNAL_METRICS == 1)
-            metric->RedundantComparatorQuick++;
-#endif
+            ++expansion.redundantQuick;
             continue;
           }
 
-          // apply new comparator and see if it causes a different output set
-          setBuffer.clear();
-          for (const ::sortnet::sequence_t s : set) {
-            const auto k{std::popcount(s) - 1};
-            setBuffer.insert(k, c.apply(s));
-          }
-          if (setBuffer == set) {
-#if (RECORD_INTERNAL_METRICS == 1)
-            metric->RedundantComparator++;
-#endif
+          // apply new comparator, which is redundant if no output changes
+          if (!::sortnet::applyComparator<N>(c, set, setBuffer)) {
+            ++expansion.redundant;
             continue;
           }
 
+          const uint64_t id{(uint64_t(segment) << 32) | expansion.generated};
           nets.at(counter) = net;
-          nets.at(counter).id = idCounter;
           nets.at(counter).push_back(c);
+          nets.at(counter).id = id;
           sets.at(counter) = setBuffer;
-          sets.at(counter).metadata.netID = idCounter;
+          sets.at(counter).metadata.netID = id;
           sets.at(counter).metadata.compute();
           ++counter;
-          ++idCounter;
+          ++expansion.generated;
 
           if (counter == ::sortnet::segment_capacity) {
-            save(nets.cbegin(), nets.cend(), sets.cbegin(), sets.cend());
-            counter = 0;
+            save();
           }
         }
       });
+
+      // check if there is anything else to write to file
+      if (counter > 0) {
+        save();
+      }
+      buffers.put(buffer);
+
+      // only the networks of the previous layer are read again, see rebuild
+      storage.Remove(file.set);
+
 #if (PRINT_PROGRESS == 1)
+      const std::lock_guard<std::mutex> lock(m);
       bar += nrOfNetworks;
       bar.display();
 #endif
+      return expansion;
+    };
+
+    std::vector<std::future<Expansion>> results{};
+    results.reserve(existingFiles.size());
+    for (std::size_t segment{0}; segment < existingFiles.size(); ++segment) {
+      results.emplace_back(pool.add(expand, segment));
     }
 
-    // check if there is anything else to write to file
+    // collect in input order, which keeps the file list deterministic
+    uint64_t generated{0};
+    auto& layerNetworkFiles{networkFiles.emplace_back()};
+
+    // tails are appended to merged until it is full
+    auto* merged = buffers.get();
+    auto* tail = buffers.get();
+    std::vector<Net> mergedNets(::sortnet::segment_capacity);
+    std::vector<Net> tailNets(::sortnet::segment_capacity);
+    uint64_t counter{0};
+    uint64_t snr{existingFiles.size() * Chunks};
+    auto save = [&, layer]() -> void {
+      const auto netFile = storage.Save(storage.folder() + storage.filenameNetworks(layer, snr),
+                                        layer, mergedNets.cbegin(), mergedNets.cbegin() + counter);
+      const auto setFile = storage.Save(storage.folder() + storage.filenameSets(layer, snr), layer,
+                                        merged->sets.cbegin(), merged->sets.cbegin() + counter);
+      ++snr;
+      filenames.emplace_back(NetAndSetFilename{
+          .net{netFile},
+          .set{setFile},
+      });
+      layerNetworkFiles.push_back(
+          NetworkFile{mergedNets.front().id, mergedNets.at(counter - 1).id, netFile});
+#if (RECORD_INTERNAL_METRICS == 1)
+      metric->FileWrite += 2;
+#endif
+      counter = 0;
+    };
+
+    for (std::size_t segment{0}; segment < results.size(); ++segment) {
+      auto expansion{pool.get(results[segment])};
+      generated += expansion.generated;
+#if (RECORD_INTERNAL_METRICS == 1)
+      metric->FileWrite += 2 * expansion.files.size();
+      metric->RedundantComparator += expansion.redundant;
+      metric->RedundantComparatorQuick += expansion.redundantQuick;
+#endif
+      const std::size_t full{expansion.files.size() - (expansion.tail > 0 ? 1 : 0)};
+      std::move(expansion.networks.begin(), expansion.networks.begin() + full,
+                std::back_inserter(layerNetworkFiles));
+      std::move(expansion.files.begin(), expansion.files.begin() + full,
+                std::back_inserter(filenames));
+      if (full == expansion.files.size()) {
+        continue;
+      }
+
+      const auto& partial{expansion.files.back()};
+      const auto size = storage.Load(partial.net, layer, tailNets.begin(), tailNets.end());
+      storage.Load(partial.set, layer, tail->sets.begin(), tail->sets.end());
+      storage.Remove(partial.net);
+      storage.Remove(partial.set);
+#if (RECORD_INTERNAL_METRICS == 1)
+      metric->FileRead += 2;
+#endif
+      for (std::size_t i{0}; i < size; ++i) {
+        mergedNets.at(counter) = tailNets.at(i);
+        merged->sets.at(counter) = tail->sets.at(i);
+        if (++counter == ::sortnet::segment_capacity) {
+          save();
+        }
+      }
+    }
     if (counter > 0) {
-      save(nets.cbegin(), nets.cbegin() + counter, sets.cbegin(), sets.cbegin() + counter);
+      save();
+    }
+    buffers.put(tail);
+    buffers.put(merged);
+#if (PRINT_PROGRESS == 1)
+    bar.done();
+#endif
+
+    return generated;
+  }
+
+  // spreads the sets of a layer over full segments in ascending order of
+  // key(set) < keys, along with their networks, and saves them under the
+  // prefix. The keys counted in every segment give each set its final
+  // position, they are counted in a first pass unless the caller has done
+  // so. The output segments are then filled in groups that fit the memory
+  // budget, where each group only reads the segments holding any of its
+  // sets. Every output segment is ordered by key and then network id.
+  template <typename Key>
+  void redistribute(uint8_t layer, const std::string& prefix, const std::size_t keys, Key key,
+                    std::vector<Histogram> counts = {}) {
+    const std::size_t Sizes{keys};
+    constexpr uint64_t Capacity{::sortnet::segment_capacity};
+    constexpr uint64_t GroupSize{std::max<uint64_t>(
+        1, ::sortnet::prune_memory_budget / (Capacity * (sizeof(Set) + sizeof(Net))))};
+
+    const auto inputs{std::move(filenames)};
+    filenames.clear();
+
+    auto count = [&, layer](const std::size_t i) -> Histogram {
+      Histogram histogram(Sizes, 0);
+      auto* buffer = buffers.get();
+      const auto size = storage.Load(inputs[i].set, layer, buffer->sets.begin(),
+                                     buffer->sets.end());
+#if (RECORD_INTERNAL_METRICS == 1)
+      metric->FileRead++;
+#endif
+      for (auto it{buffer->sets.cbegin()}; it != buffer->sets.cbegin() + size; ++it) {
+        ++histogram[key(*it)];
+      }
+      buffers.put(buffer);
+      return histogram;
+    };
+
+    if (counts.size() != inputs.size()) {
+      std::vector<std::future<Histogram>> counting{};
+      for (std::size_t i{0}; i < inputs.size(); ++i) {
+        counting.emplace_back(pool.add(count, i));
+      }
+      counts.clear();
+      for (auto& c : counting) {
+        counts.push_back(pool.get(c));
+      }
+    }
+
+    // offsets[i][s] is the position of the first set with key s in segment i
+    std::vector<Histogram> offsets(inputs.size(), Histogram(Sizes, 0));
+    uint64_t total{0};
+    for (std::size_t s{0}; s < Sizes; ++s) {
+      for (std::size_t i{0}; i < inputs.size(); ++i) {
+        offsets[i][s] = total;
+        total += counts[i][s];
+      }
+    }
+
+    const uint64_t outputs{(total + Capacity - 1) / Capacity};
+    auto& layerNetworkFiles{networkFiles.back()};
+    layerNetworkFiles.clear();
+
+#if (PRINT_PROGRESS == 1)
+    Progress bar("sorting", "files", outputs);
+    bar.display();
+#endif
+
+    for (uint64_t group{0}; group < outputs; group += GroupSize) {
+      const uint64_t base{group * Capacity};
+      const uint64_t limit{std::min(total, (group + GroupSize) * Capacity)};
+      std::vector<Set> sets(limit - base);
+      std::vector<Net> nets(limit - base);
+
+      auto scatter = [&, layer](const std::size_t i) -> void {
+        bool overlaps{false};
+        for (std::size_t s{0}; s < Sizes && !overlaps; ++s) {
+          overlaps = counts[i][s] > 0 && offsets[i][s] < limit
+                     && offsets[i][s] + counts[i][s] > base;
+        }
+        if (!overlaps) {
+          return;
+        }
+
+        auto next{offsets[i]};
+        this->read(inputs[i], layer, [&](const Net& net, const Set& set) {
+          const auto position{next[key(set)]++};
+          if (position >= base && position < limit) {
+            sets[position - base] = set;
+            nets[position - base] = net;
+          }
+        });
+      };
+
+      std::vector<std::future<void>> scattering{};
+      for (std::size_t i{0}; i < inputs.size(); ++i) {
+        scattering.emplace_back(pool.add(scatter, i));
+      }
+      for (auto& s : scattering) {
+        pool.get(s);
+      }
+
+      // networks are looked up by id, so each network file is kept in order
+      for (uint64_t first{0}; first < limit - base; first += Capacity) {
+        const auto last{std::min(first + Capacity, limit - base)};
+        const auto snr{(base + first) / Capacity};
+        std::sort(nets.begin() + first, nets.begin() + last,
+                  [](const Net& a, const Net& b) { return a.id < b.id; });
+        std::sort(sets.begin() + first, sets.begin() + last, [&](const Set& a, const Set& b) {
+          const auto x{key(a)};
+          const auto y{key(b)};
+          return x < y || (x == y && a.metadata.netID < b.metadata.netID);
+        });
+
+        const auto netFile
+            = storage.Save(storage.folder() + prefix + storage.filenameNetworks(layer, snr), layer,
+                           nets.cbegin() + first, nets.cbegin() + last);
+        const auto setFile
+            = storage.Save(storage.folder() + prefix + storage.filenameSets(layer, snr), layer,
+                           sets.cbegin() + first, sets.cbegin() + last);
+#if (RECORD_INTERNAL_METRICS == 1)
+        metric->FileWrite += 2;
+#endif
+        filenames.emplace_back(NetAndSetFilename{
+            .net{netFile},
+            .set{setFile},
+        });
+        layerNetworkFiles.push_back(
+            NetworkFile{nets.at(first).id, nets.at(last - 1).id, netFile});
+#if (PRINT_PROGRESS == 1)
+        ++bar;
+        bar.display();
+#endif
+      }
     }
 #if (PRINT_PROGRESS == 1)
     bar.done();
 #endif
 
-    return idCounter;
+    for (const auto& file : inputs) {
+      storage.Remove(file.net);
+      storage.Remove(file.set);
+    }
+  }
+
+  // sorted by size, segment i can only subsume sets in segments j >= i and
+  // the segment summaries rule out most of the other direction
+  void sortBySize(uint8_t layer) {
+    redistribute(
+        layer, "s", SizeKeys, [](const Set& set) -> std::size_t { return set.size(); },
+        std::exchange(setSizes, {}));
+  }
+
+  // the upper half of a network id is the input segment it was generated
+  // from. Networks of one input segment are alike, which is what pruning
+  // within files relies on in the next layer.
+  void sortByOrigin(uint8_t layer) {
+    uint64_t last{0};
+    for (const auto& file : networkFiles.back()) {
+      last = std::max(last, file.last);
+    }
+    redistribute(layer, "", (last >> 32) + 1, [](const Set& set) -> std::size_t {
+      return set.metadata.netID >> 32;
+    });
   }
 
   uint64_t pruneWithinFiles(uint8_t layer) {
@@ -534,11 +1059,17 @@ public:
 #endif
     };
 
-    auto prune = [&](const auto& filename) -> uint64_t {
+#if (SORT_LAYERS_BY_SIZE == 1)
+    setSizes.assign(filenames.size(), Histogram(SizeKeys, 0));
+#endif
+
+    auto prune = [&](const std::size_t i) -> uint64_t {
+      const auto& filename{filenames[i].set};
       auto* buffer = buffers.get();
       auto begin = buffer->sets.begin();
       auto end = buffer->sets.end();
 
+      writer.wait(filename);
       auto size = storage.Load(filename, layer, begin, end);
 #if (RECORD_INTERNAL_METRICS == 1)
       metric->FileRead++;
@@ -546,29 +1077,40 @@ public:
       const auto originalSize{size};
       end = begin + size;
 
+      orderBySize(begin, end);
       markRedundantNetworks(begin, end);
       size = shiftRedundant(begin, end);
+#if (SORT_LAYERS_BY_SIZE == 1)
+      for (auto it{begin}; it != begin + size; ++it) {
+        ++setSizes[i][it->size()];
+      }
+#endif
       if (size == originalSize) {
         buffers.put(buffer);
         updateProgress();
         return 0;
       }
 
-      // write results to file
-      storage.Save(filename, begin, begin + size);
+      // networks of one input segment are kept together in the order they
+      // were generated, see sortByOrigin
+      std::sort(begin, begin + size, [](const Set& a, const Set& b) {
+        return a.metadata.netID < b.metadata.netID;
+      });
+
+      // write results to file, the writer returns the buffer to the pool
+      writer.save(filename, layer, buffer, size);
 #if (RECORD_INTERNAL_METRICS == 1)
       metric->FileWrite++;
 #endif
 
-      buffers.put(buffer);
       updateProgress();
       return originalSize - size;
     };
 
     std::vector<std::future<uint64_t>> results{};
     results.reserve(filenames.size());
-    for (const auto& file : filenames) {
-      results.emplace_back(pool.add(prune, file.set));
+    for (std::size_t i{0}; i < filenames.size(); ++i) {
+      results.emplace_back(pool.add(prune, i));
     }
 
     pool.wait();
@@ -581,82 +1123,374 @@ public:
       const auto diff = r.get();
       pruned += diff;
     }
+    writer.flush();
 
     return pruned;
   }
 
+  // runs prune(x, y) on the pool for every pair of segments, such that no two
+  // pairs sharing a segment run at the same time. Every pair is a job of its
+  // own, which is added as soon as both of its segments are free, pairs listed
+  // earlier are preferred. The calling thread runs pairs as well until all of
+  // them are done.
+  template <typename Prune>
+  void prunePairs(std::vector<std::pair<std::size_t, std::size_t>> pairs,
+                  const std::size_t segments, Prune prune) {
+    std::mutex m;
+    std::vector<bool> busy(segments, false);
+    std::size_t running{0};
+    std::exception_ptr error{};
+    std::promise<void> finished{};
+    auto done{finished.get_future()};
+
+    std::function<void(std::size_t, std::size_t)> job{};
+
+    // starts every pair whose segments are free, must be called while holding
+    // the lock
+    auto schedule = [&]() {
+      for (auto it{pairs.begin()}; it != pairs.end();) {
+        const auto [x, y] = *it;
+        if (busy[x] || busy[y]) {
+          ++it;
+          continue;
+        }
+        busy[x] = true;
+        busy[y] = true;
+        ++running;
+        it = pairs.erase(it);
+        pool.add(job, x, y);
+      }
+    };
+
+    job = [&](const std::size_t x, const std::size_t y) {
+      std::exception_ptr failure{};
+      try {
+        prune(x, y);
+      } catch (...) {
+        failure = std::current_exception();
+      }
+
+      bool last{false};
+      {
+        const std::lock_guard<std::mutex> lock(m);
+        if (failure) {
+          error = failure;
+          pairs.clear();
+        }
+        busy[x] = false;
+        busy[y] = false;
+        --running;
+        schedule();
+        last = running == 0;
+      }
+      // the caller may return as soon as the promise is set
+      if (last) {
+        finished.set_value();
+      }
+    };
+
+    {
+      const std::lock_guard<std::mutex> lock(m);
+      schedule();
+      if (running == 0) {
+        return;
+      }
+    }
+    pool.get(done);
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  // prunes every segment against every other segment. The segments are
+  // processed in tiles that fit in the memory budget, see PRUNE_MEMORY_BUDGET.
+  // Each tile is loaded once as the primary tile, pruned within itself, and
+  // then pruned against every later tile while those are loaded one at a
+  // time. Every pair of segments is visited once and pruned in both
+  // directions, such that about F^2/T segments are loaded instead of F^2.
   uint64_t pruneAcrossFiles(uint8_t layer) {
-    auto prune = [&](const std::string& filename, auto begin, auto end) -> uint32_t {
-      auto* buffer = buffers.get();
-      auto begin2 = buffer->sets.begin();
-      auto end2 = buffer->sets.end();
+    struct Resident {
+      std::size_t file{0};
+      Buffer* buffer{nullptr};
+      uint32_t size{0};
+      [[nodiscard]] auto begin() const { return buffer->sets.begin(); }
+      [[nodiscard]] auto end() const { return buffer->sets.begin() + size; }
+    };
+    using Tile = std::vector<Resident>;
+
+    // a tile whose segments are still being loaded, see load. The loads write
+    // into the tile, so it is not released before they are done.
+    struct Loading {
+      Tile tile{};
+      std::vector<std::future<void>> loads{};
+
+      Loading() = default;
+      Loading(Loading&&) noexcept = default;
+      Loading& operator=(Loading&&) noexcept = default;
+      ~Loading() {
+        for (auto& l : loads) {
+          if (l.valid()) {
+            l.wait();
+          }
+        }
+      }
+    };
 
-      auto size = storage.Load(filename, layer, begin2, end2);
+    // starts loading the wanted segments of a tile, each in its own pool job or
+    // all of them in one batch where the storage supports it, and returns right
+    // away. The other segments are left empty.
+    auto load = [&](const std::size_t first, const std::size_t last, auto wanted) -> Loading {
+      Loading loading{};
+      loading.tile = Tile(last - first);
+      std::vector<Resident*> segments{};
+      for (std::size_t k{0}; k < loading.tile.size(); ++k) {
+        Resident* segment{&loading.tile[k]};
+        segment->file = first + k;
+        if (!wanted(segment->file)) {
 #if (RECORD_INTERNAL_METRICS == 1)
-      metric->FileRead++;
+          metric->SegmentLoadsSkipped++;
 #endif
-      if (size == 0) {
-        buffers.put(buffer);
-        return 0;
+          continue;
+        }
+        segments.push_back(segment);
       }
-      const auto sizeBeforePruning{size};
 
-      end2 = begin2 + size;
-      markRedundantNetworks(begin, end, begin2, end2);
-      size = shiftRedundant(begin2, end2);
+      if constexpr (BatchedLoads) {
+        if (segments.empty()) {
+          return loading;
+        }
+        loading.loads.emplace_back(pool.add([this, segments, layer]() {
+          std::vector<Request> requests{};
+          requests.reserve(segments.size());
+          for (Resident* segment : segments) {
+            const auto& filename{filenames.at(segment->file).set};
+            segment->buffer = buffers.get();
+            writer.wait(filename);
+            requests.push_back(Request{.filename = filename,
+                                       .begin = segment->buffer->sets.begin(),
+                                       .end = segment->buffer->sets.end()});
+          }
+          storage.Load(std::span<Request>(requests), layer);
+          for (std::size_t k{0}; k < segments.size(); ++k) {
+            segments[k]->size = requests[k].size;
+          }
+#if (RECORD_INTERNAL_METRICS == 1)
+          metric->FileRead += segments.size();
+#endif
+        }));
+        return loading;
+      }
 
-      // write results to file if anything changed
-      const uint32_t pruned = sizeBeforePruning - size;
-      if (pruned > 0) {
-        storage.Save(filename, begin2, begin2 + size);
+      for (Resident* segment : segments) {
+        loading.loads.emplace_back(pool.add([this, segment, layer]() {
+          const auto& filename{filenames.at(segment->file).set};
+          segment->buffer = buffers.get();
+          writer.wait(filename);
+          segment->size = storage.Load(filename, layer, segment->buffer->sets.begin(),
+                                       segment->buffer->sets.end());
+#if (RECORD_INTERNAL_METRICS == 1)
+          metric->FileRead++;
+#endif
+        }));
+      }
+      return loading;
+    };
+
+    // blocks until every segment of the tile has been loaded
+    auto ready = [this](Loading loading) -> Tile {
+      for (auto& l : loading.loads) {
+        pool.get(l);
+      }
+      return std::move(loading.tile);
+    };
+
+    // saves the segments of a tile that lost sets, and hands back the buffers
+    auto store = [&](Tile& tile) -> uint64_t {
+      uint64_t pruned{0};
+      for (auto& segment : tile) {
+        if (segment.buffer == nullptr) {
+          continue;
+        }
+        const auto size{shiftRedundant(segment.begin(), segment.end())};
+        if (size == segment.size) {
+          buffers.put(segment.buffer);
+          continue;
+        }
+        pruned += segment.size - size;
+        writer.save(filenames.at(segment.file).set, layer, segment.buffer, size);
 #if (RECORD_INTERNAL_METRICS == 1)
         metric->FileWrite++;
 #endif
       }
-      buffers.put(buffer);
+      tile.clear();
       return pruned;
     };
 
+    // pairs of the segments within a tile, ordered in rounds of disjoint pairs
+    // (the circle method) such that consecutive pairs rarely share a segment
+    auto within = [](const std::size_t n) {
+      std::vector<std::pair<std::size_t, std::size_t>> pairs{};
+      const std::size_t m{n + (n % 2)};
+      for (std::size_t round{0}; round + 1 < m; ++round) {
+        if (m - 1 < n) {
+          pairs.emplace_back(round, m - 1);
+        }
+        for (std::size_t k{1}; k < m / 2; ++k) {
+          pairs.emplace_back((round + k) % (m - 1), (round + m - 1 - k) % (m - 1));
+        }
+      }
+      return pairs;
+    };
+
+    // pairs of a segment in a tile of size a with a segment in the following
+    // tile of size b, also ordered in rounds of disjoint pairs
+    auto between = [](const std::size_t a, const std::size_t b) {
+      std::vector<std::pair<std::size_t, std::size_t>> pairs{};
+      for (std::size_t round{0}; round < std::max(a, b); ++round) {
+        for (std::size_t k{0}; k < std::min(a, b); ++k) {
+          if (a <= b) {
+            pairs.emplace_back(k, a + (k + round) % b);
+          } else {
+            pairs.emplace_back((k + round) % a, a + k);
+          }
+        }
+      }
+      return pairs;
+    };
+
+    const std::size_t count{filenames.size()};
+    const std::size_t tileSize{TileSize};
+
+    // the summaries in the segment headers rule out pairs of segments in
+    // which no set can subsume another, before any of them is loaded. A
+    // summary only gets wider than the sets it describes as sets are pruned.
+    std::vector<::sortnet::segment::Header> headers(count);
+    for (std::size_t i{0}; i < count; ++i) {
+      writer.wait(filenames.at(i).set);
+      headers[i] = storage.template Peek<Set>(filenames.at(i).set);
+    }
+    auto pairable = [&](const std::size_t x, const std::size_t y) -> bool {
+      return ::sortnet::segment::maySubsume<N>(headers[x], headers[y])
+             || ::sortnet::segment::maySubsume<N>(headers[y], headers[x]);
+    };
+
 #if (PRINT_PROGRESS == 1)
-    // TODO: n'th triangle number
-    Progress bar("pruning", "across files", filenames.size());
+    const std::size_t tiles{(count + tileSize - 1) / tileSize};
+    Progress bar("pruning", "across files", tiles * (tiles + 1) / 2);
     bar.display();
 #endif
 
-    auto* buffer = buffers.get();
-    auto& sets = buffer->sets;
-    std::vector<std::future<uint32_t>> results{};
     uint64_t pruned{0};
-    for (std::size_t i{0}; i < filenames.size(); ++i) {
-      const auto& file{filenames.at(i)};
-      auto size = storage.Load(file.set, layer, sets.begin(), sets.end());
-#if (RECORD_INTERNAL_METRICS == 1)
-      metric->FileRead++;
+    for (std::size_t a{0}; a < count; a += tileSize) {
+      // a segment of the primary tile is loaded when it is pruned within
+      // itself or pairs with any segment of this tile or a later one
+      auto primary{ready(load(a, std::min(a + tileSize, count), [&](const std::size_t x) {
+#if (SORT_LAYERS_BY_SIZE == 1)
+        if (headers[x].count > 1) {
+          return true;
+        }
 #endif
-      if (size == 0) {
-        continue;
-      }
-
-      for (std::size_t j{0}; j < filenames.size(); ++j) {
-        if (j == i) {
-          continue;
+        for (std::size_t y{a}; y < count; ++y) {
+          if (y != x && pairable(x, y)) {
+            return true;
+          }
         }
-        const auto& filename{filenames.at(j).set};
-        results.emplace_back(pool.add(prune, filename, sets.cbegin(), sets.cbegin() + size));
-      }
-      pool.wait();
+        return false;
+      }))};
+      Tile resident{primary};
+
+      // pairs are only pruned in the directions the summaries allow, which
+      // is a single one for most pairs once the layer is sorted by size
+      auto prune = [&](const std::size_t x, const std::size_t y) {
+        const auto& a{resident[x]};
+        const auto& b{resident[y]};
+        if (a.size == 0 || b.size == 0) {
+          return;
+        }
+        if (x == y) {
+          orderBySize(a.begin(), a.end());
+          markRedundantNetworks(a.begin(), a.end());
+          return;
+        }
+        const auto forward{::sortnet::segment::maySubsume<N>(headers[a.file], headers[b.file])};
+        const auto backward{::sortnet::segment::maySubsume<N>(headers[b.file], headers[a.file])};
+        if (forward) {
+          markRedundantNetworks(a.begin(), a.end(), b.begin(), b.end(), backward);
+        } else if (backward) {
+          markRedundantNetworks(b.begin(), b.end(), a.begin(), a.end(), false);
+        }
+      };
 
-      for (auto& r : results) {
-        const auto diff = r.get();
-        pruned += diff;
+      // drops the pairs ruled out by the summaries
+      auto candidates = [&](std::vector<std::pair<std::size_t, std::size_t>> pairs) {
+        const auto skipped{std::erase_if(pairs, [&](const auto& pair) {
+          return !pairable(resident[pair.first].file, resident[pair.second].file);
+        })};
+#if (RECORD_INTERNAL_METRICS == 1)
+        metric->SegmentPairs += pairs.size() + skipped;
+        metric->SegmentPairsSkipped += skipped;
+        const auto oneWay = [&](const auto& pair) {
+          const auto x{resident[pair.first].file};
+          const auto y{resident[pair.second].file};
+          return !(::sortnet::segment::maySubsume<N>(headers[x], headers[y])
+                   && ::sortnet::segment::maySubsume<N>(headers[y], headers[x]));
+        };
+        metric->SegmentPairsOneWay += std::count_if(pairs.cbegin(), pairs.cend(), oneWay);
+#else
+        static_cast<void>(skipped);
+#endif
+        return pairs;
+      };
+
+      auto pairs{candidates(within(primary.size()))};
+#if (SORT_LAYERS_BY_SIZE == 1)
+      // sorting brought together sets that were generated in different files,
+      // so every segment is also pruned within itself
+      for (std::size_t k{0}; k < primary.size(); ++k) {
+        pairs.emplace(pairs.begin() + k, k, k);
       }
-      results.clear();
+#endif
+      prunePairs(std::move(pairs), resident.size(), prune);
 #if (PRINT_PROGRESS == 1)
       ++bar;
       bar.display();
 #endif
+
+      // a secondary tile only loads the segments that pair with the primary
+      // tile. The next one is loaded while the current one is pruned.
+      auto loadSecondary = [&](const std::size_t b) -> Loading {
+        if (b >= count) {
+          return {};
+        }
+        return load(b, std::min(b + tileSize, count), [&](const std::size_t y) {
+          return std::any_of(primary.cbegin(), primary.cend(), [&](const Resident& x) {
+            return x.buffer != nullptr && pairable(x.file, y);
+          });
+        });
+      };
+
+      auto next{loadSecondary(a + tileSize)};
+      for (std::size_t b{a + tileSize}; b < count; b += tileSize) {
+        auto secondary{ready(std::move(next))};
+        next = loadSecondary(b + tileSize);
+        resident = primary;
+        resident.insert(resident.end(), secondary.begin(), secondary.end());
+
+        prunePairs(candidates(between(primary.size(), secondary.size())), resident.size(),
+                   prune);
+        pruned += store(secondary);
+#if (PRINT_PROGRESS == 1)
+        ++bar;
+        bar.display();
+#endif
+      }
+      pruned += store(primary);
     }
-    buffers.put(buffer);
+
+    writer.flush();
+    // the buffers of three tiles are not needed before the next layer is
+    // pruned across files
+    buffers.clear();
 
 #if (PRINT_PROGRESS == 1)
     bar.done();
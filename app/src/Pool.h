@@ -34,5 +34,14 @@ public:
     const std::lock_guard<std::mutex> lock(m);
     objects.push_back(obj);
   }
+
+  // frees the objects that are not in use
+  void clear() {
+    const std::lock_guard<std::mutex> lock(m);
+    for (T* obj : objects) {
+      delete obj;
+    }
+    objects.clear();
+  }
 };
 }  // namespace sortnet
\ No newline at end of file
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace sortnet {
+// WorkStealingPool runs jobs on a fixed set of threads that each own a queue.
+// A job added from one of the threads goes to the front of its own queue, other
+// jobs are spread over the queues round robin. A thread takes jobs from the
+// front of its own queue and steals from the back of the others when it runs
+// dry, so the threads rarely contend for the same lock. A thread that waits on
+// the pool, see wait and get, steals and runs jobs until it may continue.
+class WorkStealingPool {
+private:
+  using Job = std::function<void()>;
+
+  struct Queue {
+    std::mutex m;
+    std::deque<Job> jobs{};
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues{};
+  std::vector<std::thread> threads{};
+
+  std::atomic<std::size_t> next{0};
+  // jobs not yet taken. A job is counted once it is in a queue, and may be
+  // taken before that, so this can drop below zero for a moment.
+  std::atomic<std::ptrdiff_t> queued{0};
+  std::atomic<std::size_t> pending{0};  // jobs not yet completed
+  std::atomic<std::size_t> helping{0};  // threads waiting in help
+  bool terminate{false};
+
+  std::mutex m;
+  std::condition_variable changed;
+
+  // the pool and queue of the calling thread, if it belongs to a pool
+  struct Owner {
+    const WorkStealingPool *pool{nullptr};
+    std::size_t index{0};
+  };
+  static Owner &self() {
+    thread_local Owner owner{};
+    return owner;
+  }
+
+  // takes a job from the front of queue index, or steals one from the back of
+  // another queue. An index past the queues only steals.
+  bool take(const std::size_t index, Job &job) {
+    for (std::size_t k{0}; k < queues.size(); ++k) {
+      auto &queue{*queues[(index + k) % queues.size()]};
+      const std::lock_guard<std::mutex> lock(queue.m);
+      if (queue.jobs.empty()) {
+        continue;
+      }
+      if (k == 0 && index < queues.size()) {
+        job = std::move(queue.jobs.front());
+        queue.jobs.pop_front();
+      } else {
+        job = std::move(queue.jobs.back());
+        queue.jobs.pop_back();
+      }
+      --queued;
+      return true;
+    }
+    return false;
+  }
+
+  // runs one job, if there is any
+  bool run(const std::size_t index) {
+    Job job{};
+    if (!take(index, job)) {
+      return false;
+    }
+    job();
+    job = nullptr;
+    if (--pending == 0 || helping > 0) {
+      const std::lock_guard<std::mutex> lock(m);
+      changed.notify_all();
+    }
+    return true;
+  }
+
+  void work(const std::size_t index) {
+    self() = Owner{this, index};
+    while (true) {
+      if (run(index)) {
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(m);
+      changed.wait(lock, [&]() { return (terminate && pending == 0) || queued > 0; });
+      if (terminate && pending == 0) {
+        return;
+      }
+    }
+  }
+
+  // runs jobs on the calling thread until done() holds
+  template <typename Done> void help(Done done) {
+    ++helping;
+    while (!done()) {
+      if (run(queues.size())) {
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(m);
+      changed.wait(lock, [&]() { return queued > 0 || done(); });
+    }
+    --helping;
+  }
+
+public:
+  explicit WorkStealingPool(std::size_t threadCount = 0) {
+    if (threadCount == 0) {
+      threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (std::size_t i{0}; i < threadCount; ++i) {
+      queues.push_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i{0}; i < threadCount; ++i) {
+      threads.emplace_back(&WorkStealingPool::work, this, i);
+    }
+  }
+
+  WorkStealingPool(const WorkStealingPool &) = delete;
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+  // queued jobs, and the jobs they add, are completed before the threads stop
+  ~WorkStealingPool() {
+    {
+      const std::lock_guard<std::mutex> lock(m);
+      terminate = true;
+    }
+    changed.notify_all();
+    for (auto &t : threads) {
+      t.join();
+    }
+  }
+
+  [[nodiscard]] std::size_t threadCount() const { return threads.size(); }
+
+  // add a function to be executed, along with any arguments for it
+  template <typename Func, typename... Args> auto add(Func &&func, Args &&...args) {
+    using Result = std::invoke_result_t<std::decay_t<Func>, std::decay_t<Args>...>;
+    auto task{std::make_shared<std::packaged_task<Result()>>(
+        std::bind(std::forward<Func>(func), std::forward<Args>(args)...))};
+    auto future{task->get_future()};
+
+    ++pending;
+    if (const auto &owner{self()}; owner.pool == this) {
+      const std::lock_guard<std::mutex> lock(queues[owner.index]->m);
+      queues[owner.index]->jobs.emplace_front([task]() { (*task)(); });
+    } else {
+      auto &queue{*queues[next++ % queues.size()]};
+      const std::lock_guard<std::mutex> lock(queue.m);
+      queue.jobs.emplace_back([task]() { (*task)(); });
+    }
+    {
+      const std::lock_guard<std::mutex> lock(m);
+      ++queued;
+    }
+    changed.notify_one();
+    return future;
+  }
+
+  // blocks until every added job has completed, and runs jobs meanwhile
+  void wait() {
+    help([&]() { return pending == 0; });
+  }
+
+  // blocks until the job of the future has completed, and runs jobs meanwhile
+  template <typename T> T get(std::future<T> &future) {
+    help([&]() { return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+    return future.get();
+  }
+};
+}  // namespace sortnet
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace sortnet {
+// WriteBehind saves pruned segments on dedicated I/O threads, such that a
+// pruning task can continue with its next segment right away. The queue owns
+// a buffer from the moment it is handed over until the segment has been
+// saved, and then returns it to the buffer pool.
+//
+// At most one save per file is in flight, and wait(filename) blocks until the
+// file has been saved. Every load of a segment that may have been saved
+// through the queue must wait for it first.
+template <typename Storage, typename Buffers, typename Buffer> class WriteBehind {
+private:
+  struct Job {
+    std::string filename;
+    uint8_t layer;
+    Buffer *buffer;
+    uint32_t size;
+  };
+
+  Storage &storage;
+  Buffers &buffers;
+  const std::size_t capacity;
+
+  std::mutex m;
+  std::condition_variable changed;
+  std::deque<Job> jobs{};
+  std::set<std::string> pending{};
+  std::exception_ptr error{};
+  bool stop{false};
+  std::vector<std::thread> threads{};
+
+  void work() {
+    std::unique_lock<std::mutex> lock(m);
+    while (true) {
+      changed.wait(lock, [&]() { return stop || !jobs.empty(); });
+      if (jobs.empty()) {
+        return;
+      }
+      const Job job{std::move(jobs.front())};
+      jobs.pop_front();
+      changed.notify_all();  // there is room in the queue
+      lock.unlock();
+
+      try {
+        const auto begin{job.buffer->sets.cbegin()};
+        storage.Save(job.filename, job.layer, begin, begin + job.size);
+      } catch (...) {
+        const std::lock_guard<std::mutex> guard(m);
+        error = std::current_exception();
+      }
+      buffers.put(job.buffer);
+
+      lock.lock();
+      pending.erase(job.filename);
+      changed.notify_all();
+    }
+  }
+
+  void rethrow() {
+    if (error) {
+      std::rethrow_exception(std::exchange(error, nullptr));
+    }
+  }
+
+public:
+  WriteBehind(Storage &storage, Buffers &buffers, const std::size_t nrOfThreads,
+              const std::size_t capacity)
+      : storage(storage), buffers(buffers), capacity(capacity) {
+    for (std::size_t i{0}; i < nrOfThreads; ++i) {
+      threads.emplace_back(&WriteBehind::work, this);
+    }
+  }
+
+  WriteBehind(const WriteBehind &) = delete;
+  WriteBehind &operator=(const WriteBehind &) = delete;
+
+  // remaining jobs are saved before the threads stop
+  ~WriteBehind() {
+    {
+      const std::lock_guard<std::mutex> lock(m);
+      stop = true;
+    }
+    changed.notify_all();
+    for (auto &t : threads) {
+      t.join();
+    }
+  }
+
+  // queue the first size sets of the buffer to be saved as filename, blocks
+  // while the queue is full or the file is still being saved
+  void save(const std::string &filename, const uint8_t layer, Buffer *buffer,
+            const uint32_t size) {
+    std::unique_lock<std::mutex> lock(m);
+    changed.wait(lock, [&]() { return jobs.size() < capacity && !pending.contains(filename); });
+    rethrow();
+    jobs.push_back(Job{filename, layer, buffer, size});
+    pending.insert(filename);
+    changed.notify_all();
+  }
+
+  // blocks until the file is no longer queued or being saved
+  void wait(const std::string &filename) {
+    std::unique_lock<std::mutex> lock(m);
+    changed.wait(lock, [&]() { return !pending.contains(filename); });
+    rethrow();
+  }
+
+  // blocks until every queued file has been saved
+  void flush() {
+    std::unique_lock<std::mutex> lock(m);
+    changed.wait(lock, [&]() { return pending.empty(); });
+    rethrow();
+  }
+};
+}  // namespace sortnet
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "memoryStorage.h"
+#include "persistentStorage.h"
+#include "sortnet/metric.h"
+#include "sortnet/segment.h"
+
+// HybridStorage keeps recently used segments in RAM up to a byte budget, see
+// STORAGE_MEMORY_BUDGET, and spills the least recently used ones to disk in
+// the format of PersistentStorage. A segment is only written when it is
+// spilled and differs from its copy on disk.
+//
+// The lock only guards the index. Files are read and spilled outside of it,
+// while pending holds their state such that a segment is never read from
+// disk before it has been completely written.
+template <::sortnet::concepts::NetworkRecord Net, ::sortnet::concepts::Set Set, uint8_t N,
+          uint8_t K>
+class HybridStorage : public PersistentStorage<Net, Set, N, K> {
+private:
+  using Base = PersistentStorage<Net, Set, N, K>;
+
+  template <typename T> struct Resident {
+    ::sortnet::segment::Header header{};
+    std::shared_ptr<const std::vector<T>> records{};
+    std::list<std::string>::iterator used{};
+    bool dirty{false};
+  };
+
+  // a dirty segment taken out of memory, which is saved once the lock is
+  // released
+  struct Spill {
+    std::string filename{};
+    std::function<void()> save{};
+    std::promise<void> done{};
+  };
+
+  std::mutex mutex{};
+  std::map<std::string, Resident<Set>> sets{};
+  std::map<std::string, Resident<Net>> nets{};
+  std::map<std::string, std::shared_future<void>> pending{};  // files being read or spilled
+  std::list<std::string> lru{};  // most recently used first
+  uint64_t residentBytes{0};
+
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> misses{0};
+  std::atomic<uint64_t> spilledBytes{0};
+
+  template <typename T> auto &residents() {
+    if constexpr (std::is_same_v<T, Set>) {
+      return sets;
+    } else {
+      return nets;
+    }
+  }
+
+  template <typename T> static uint64_t bytes(const std::vector<T> &records) {
+    return records.size() * sizeof(T);
+  }
+
+  // waits until no other thread reads or spills the file, and returns with the
+  // lock held
+  std::unique_lock<std::mutex> settle(const std::string &filename) {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (auto it{pending.find(filename)}; it != pending.end(); it = pending.find(filename)) {
+      const auto done{it->second};
+      lock.unlock();
+      done.wait();
+      lock.lock();
+    }
+    return lock;
+  }
+
+  template <typename T>
+  void spill(typename std::map<std::string, Resident<T>>::iterator it, std::vector<Spill> &spills) {
+    auto &segment{it->second};
+    residentBytes -= bytes(*segment.records);
+    lru.erase(segment.used);
+    if (segment.dirty) {
+      Spill spill{
+          .filename = it->first,
+          .save = [this, filename = it->first, layer = segment.header.layer,
+                   records = segment.records]() {
+            Base::Save(filename, layer, records->cbegin(), records->cend());
+            spilledBytes += bytes(*records);
+          },
+      };
+      pending.emplace(it->first, spill.done.get_future().share());
+      spills.push_back(std::move(spill));
+    }
+    residents<T>().erase(it);
+  }
+
+  // spill the least recently used segments until the budget is met, the most
+  // recent segment is always kept
+  void evict(std::vector<Spill> &spills) {
+    while (residentBytes > ::sortnet::storage_memory_budget && lru.size() > 1) {
+      const auto &filename{lru.back()};
+      if (const auto it{sets.find(filename)}; it != sets.end()) {
+        spill<Set>(it, spills);
+      } else {
+        spill<Net>(nets.find(filename), spills);
+      }
+    }
+  }
+
+  // saves the spilled segments, which must happen without holding the lock
+  void write(std::vector<Spill> &spills) {
+    std::exception_ptr error{};
+    for (auto &spill : spills) {
+      try {
+        spill.save();
+      } catch (...) {
+        error = std::current_exception();
+      }
+      {
+        const std::lock_guard<std::mutex> lock(mutex);
+        pending.erase(spill.filename);
+      }
+      spill.done.set_value();
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  template <typename T>
+  void insert(const std::string &filename, Resident<T> segment, std::vector<Spill> &spills) {
+    auto &residents{this->residents<T>()};
+    if (const auto it{residents.find(filename)}; it != residents.end()) {
+      residentBytes -= bytes(*it->second.records);
+      lru.erase(it->second.used);
+      residents.erase(it);
+    }
+
+    lru.push_front(filename);
+    segment.used = lru.begin();
+    residentBytes += bytes(*segment.records);
+    residents.emplace(filename, std::move(segment));
+    evict(spills);
+  }
+
+  template <typename T> static Resident<T> read(const std::string &filename) {
+    std::ifstream f{filename, std::ios::in | std::ios::binary};
+    if (!f) {
+      throw std::runtime_error("no segment was saved as " + filename);
+    }
+    ::sortnet::segment::Header header{};
+    ::sortnet::binary_read(f, header);
+    f.seekg(0);
+
+    auto records{std::make_shared<std::vector<T>>(header.count)};
+    ::sortnet::segment::read<N, K>(f, header.layer, records->begin(), records->end());
+
+    return Resident<T>{
+        .header = header,
+        .records = std::move(records),
+    };
+  }
+
+  // the records of a segment, which are read from disk when not resident.
+  // Other readers of the file wait until it is resident.
+  template <typename T> Resident<T> acquire(const std::string &filename) {
+    auto lock{settle(filename)};
+    auto &residents{this->residents<T>()};
+    if (const auto it{residents.find(filename)}; it != residents.end()) {
+      ++hits;
+      lru.splice(lru.begin(), lru, it->second.used);
+      return it->second;
+    }
+    ++misses;
+
+    std::promise<void> loaded{};
+    pending.emplace(filename, loaded.get_future().share());
+    lock.unlock();
+
+    Resident<T> segment{};
+    try {
+      segment = read<T>(filename);
+    } catch (...) {
+      lock.lock();
+      pending.erase(filename);
+      lock.unlock();
+      loaded.set_value();
+      throw;
+    }
+
+    std::vector<Spill> spills{};
+    lock.lock();
+    pending.erase(filename);
+    insert(filename, segment, spills);
+    lock.unlock();
+    loaded.set_value();
+    write(spills);
+    return segment;
+  }
+
+public:
+  using Base::Save;
+
+  template <typename II, typename II2>
+  std::string Save(const std::string &filename, uint8_t layer, II begin, II2 end) {
+    using T = std::iter_value_t<II>;
+    Resident<T> segment{
+        .header = ::sortnet::segment::header<N, K>(layer, begin, end),
+        .records = std::make_shared<const std::vector<T>>(begin, end),
+        .dirty = true,
+    };
+    std::vector<Spill> spills{};
+    {
+      const auto lock{settle(filename)};
+      insert(filename, std::move(segment), spills);
+    }
+    write(spills);
+    return std::string(filename);
+  }
+
+  template <typename II, typename II2>
+  std::string Save(uint8_t layer, II begin, const II2 end, const std::string &prefix = "") {
+    std::string filename{this->dir + prefix + this->createFilename(*begin, layer)};
+    return Save(filename, layer, begin, end);
+  }
+
+  template <typename iterator>
+  uint32_t Load(const std::string &filename, uint8_t layer, iterator it, iterator end) {
+    using T = std::iter_value_t<iterator>;
+    const auto segment{acquire<T>(filename)};
+    if (segment.header.layer != layer) {
+      throw std::runtime_error("the segment belongs to another layer");
+    }
+    const auto limit{std::min<std::size_t>(segment.records->size(), std::distance(it, end))};
+    std::copy(segment.records->cbegin(), segment.records->cbegin() + limit, it);
+    return static_cast<uint32_t>(limit);
+  }
+
+  // a read-only view of a segment, valid for as long as the returned segment
+  // lives
+  template <typename T> MemorySegment<T> Map(const std::string &filename) {
+    return MemorySegment<T>(acquire<T>(filename).records);
+  }
+
+  // the header of a segment, which is only read from disk when the segment is
+  // not resident. Peeking does not count as a hit or miss.
+  template <typename T> ::sortnet::segment::Header Peek(const std::string &filename) {
+    {
+      const auto lock{settle(filename)};
+      auto &residents{this->residents<T>()};
+      if (const auto it{residents.find(filename)}; it != residents.end()) {
+        return it->second.header;
+      }
+    }
+    return Base::template Peek<T>(filename);
+  }
+
+  // views of the segment stay valid
+  void Remove(const std::string &filename) {
+    {
+      const auto lock{settle(filename)};
+      auto drop = [&](auto &residents) {
+        if (const auto it{residents.find(filename)}; it != residents.end()) {
+          residentBytes -= bytes(*it->second.records);
+          lru.erase(it->second.used);
+          residents.erase(it);
+        }
+      };
+      drop(sets);
+      drop(nets);
+    }
+    Base::Remove(filename);
+  }
+
+  // moves the counters of the current layer into its metrics
+  void record(::sortnet::MetricLayer &metric) {
+    metric.StorageHits += hits.exchange(0);
+    metric.StorageMisses += misses.exchange(0);
+    metric.StorageSpilledBytes += spilledBytes.exchange(0);
+  }
+};
@@ -7,15 +7,44 @@
 #define PREFER_SAFETY 1
 #define RECORD_IO_TIME 0
 
+// output set representation
+#define OUTPUT_SET_LIST_NAIVE 0
+#define OUTPUT_SET_BITMAP 1
+#define OUTPUT_SET_PARTITIONED_VECTOR 2
+#define OUTPUT_SET OUTPUT_SET_BITMAP
+
+// network representation in the n*.gnp files
+#define NETWORK_RECORD_FULL 0
+#define NETWORK_RECORD_LINK 1
+#define NETWORK_RECORD NETWORK_RECORD_LINK
+
+// segment files, mapped storage requires OUTPUT_SET_BITMAP and NETWORK_RECORD_LINK.
+// Memory storage keeps every segment in RAM, which suits N <= 8, while hybrid
+// storage keeps as many as STORAGE_MEMORY_BUDGET allows and spills the rest.
+// Uring storage does the file I/O through io_uring, or pread/pwrite without it.
+#define STORAGE_STREAM 0
+#define STORAGE_MAPPED 1
+#define STORAGE_MEMORY 2
+#define STORAGE_HYBRID 3
+#define STORAGE_URING 4
+#define STORAGE STORAGE_MAPPED
+
+#include <sortnet/networks/Link.h>
 #include <sortnet/networks/Network.h>
+#include <sortnet/sets/Bitmap.h>
 #include <sortnet/sets/ListNaive.h>
+#include <sortnet/sets/PartitionedVector.h>
 
 #include <cxxopts.hpp>
 #include <iostream>
 
 #include "GenerateAndPrune.h"
+#include "hybridStorage.h"
+#include "mappedStorage.h"
+#include "memoryStorage.h"
 #include "persistentStorage.h"
 #include "settings.h"
+#include "uringStorage.h"
 
 constexpr uint8_t N{PARAM_N > 0 ? PARAM_N : 7};
 constexpr uint8_t K{PARAM_K > 0 ? PARAM_K : ::sortnet::networkSizeUpperBound<N>()};
@@ -51,9 +80,29 @@ int main(int argc, char** argv) {
   }
 
   std::ios::sync_with_stdio(false);
+#if (OUTPUT_SET == OUTPUT_SET_BITMAP)
+  using Set = ::sortnet::set::Bitmap<N, K>;
+#elif (OUTPUT_SET == OUTPUT_SET_PARTITIONED_VECTOR)
+  using Set = ::sortnet::set::PartitionedVector<N, K>;
+#else
   using Set = ::sortnet::set::ListNaive<N, K>;
+#endif
+#if (NETWORK_RECORD == NETWORK_RECORD_LINK)
+  using Net = ::sortnet::network::Link<N, K>;
+#else
   using Net = ::sortnet::network::Network<N, K>;
+#endif
+#if (STORAGE == STORAGE_MAPPED)
+  using Storage = MappedStorage<Net, Set, N, K>;
+#elif (STORAGE == STORAGE_MEMORY)
+  using Storage = MemoryStorage<Net, Set, N, K>;
+#elif (STORAGE == STORAGE_HYBRID)
+  using Storage = HybridStorage<Net, Set, N, K>;
+#elif (STORAGE == STORAGE_URING)
+  using Storage = UringStorage<Net, Set, N, K>;
+#else
   using Storage = PersistentStorage<Net, Set, N, K>;
+#endif
 
   auto g = GenerateAndPrune<N, K, Threads - 1, Set, Net, Storage>{};
   const auto m = g.run();
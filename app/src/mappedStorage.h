@@ -0,0 +1,147 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "persistentStorage.h"
+#include "sortnet/segment.h"
+
+// MappedSegment is a read-only view of the records in a segment file, see
+// sortnet/segment.h for the layout. The records are used in place from the mapped pages, so
+// nothing is deserialized or allocated.
+template <typename T> class MappedSegment {
+private:
+  void *addr{nullptr};
+  std::size_t length{0};
+  const T *records{nullptr};
+  uint32_t count{0};
+
+public:
+  MappedSegment() = default;
+  explicit MappedSegment(const std::string &filename) {
+    using ::sortnet::segment::Header;
+    const int fd{::open(filename.c_str(), O_RDONLY)};
+    if (fd < 0) {
+      throw std::runtime_error("unable to open segment file " + filename);
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+      ::close(fd);
+      throw std::runtime_error("segment file " + filename + " has no header");
+    }
+
+    length = static_cast<std::size_t>(st.st_size);
+    addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+      addr = nullptr;
+      throw std::runtime_error("unable to map segment file " + filename);
+    }
+
+    const auto &h{header()};
+    if (h.recordSize != sizeof(T) || ::sortnet::segment::offset<T>(h.count) > length) {
+      ::munmap(addr, length);
+      addr = nullptr;
+      throw std::runtime_error("segment file " + filename + " has a different record layout");
+    }
+    count = h.count;
+    records = reinterpret_cast<const T *>(static_cast<const char *>(addr) + sizeof(Header));
+  }
+
+  MappedSegment(const MappedSegment &) = delete;
+  MappedSegment &operator=(const MappedSegment &) = delete;
+  MappedSegment(MappedSegment &&rhs) noexcept { *this = std::move(rhs); }
+  MappedSegment &operator=(MappedSegment &&rhs) noexcept {
+    std::swap(addr, rhs.addr);
+    std::swap(length, rhs.length);
+    std::swap(records, rhs.records);
+    std::swap(count, rhs.count);
+    return *this;
+  }
+
+  ~MappedSegment() {
+    if (addr != nullptr) {
+      ::munmap(addr, length);
+    }
+  }
+
+  [[nodiscard]] const ::sortnet::segment::Header &header() const {
+    return *static_cast<const ::sortnet::segment::Header *>(addr);
+  }
+
+  [[nodiscard]] uint32_t size() const { return count; }
+  [[nodiscard]] const T &operator[](const std::size_t i) const { return records[i]; }
+  [[nodiscard]] const T *begin() const { return records; }
+  [[nodiscard]] const T *end() const { return records + count; }
+};
+
+// MappedStorage reads the fixed size records of a segment file through mmap.
+// Loading a segment is a single copy from the page cache, and Map gives
+// read-only access to a segment without any copy at all. Only trivially
+// copyable records are supported, ie. set::Bitmap and network::Link.
+//
+// A segment is saved to a temporary file which is then renamed over the old
+// one, such that a mapping that is still alive keeps seeing the old content.
+template <::sortnet::concepts::NetworkRecord Net, ::sortnet::concepts::Set Set, uint8_t N,
+          uint8_t K>
+class MappedStorage : public PersistentStorage<Net, Set, N, K> {
+private:
+  using Base = PersistentStorage<Net, Set, N, K>;
+
+  static_assert(std::is_trivially_copyable_v<Set> && std::is_trivially_copyable_v<Net>,
+                "mapped storage requires trivially copyable sets and networks");
+
+public:
+  using Base::Save;
+
+  template <typename II, typename II2>
+  std::string Save(const std::string &filename, uint8_t layer, II begin, II2 end) {
+    const std::string tmp{filename + ".tmp"};
+    Base::Save(tmp, layer, begin, end);
+    std::filesystem::rename(tmp, filename);
+    return std::string(filename);
+  }
+
+  template <typename II, typename II2>
+  std::string Save(uint8_t layer, II begin, const II2 end, const std::string &prefix = "") {
+    std::string filename{this->dir + prefix + this->createFilename(*begin, layer)};
+    return Save(filename, layer, begin, end);
+  }
+
+  template <typename iterator>
+  uint32_t Load(const std::string &filename, uint8_t layer, iterator it, iterator end) {
+#if (RECORD_IO_TIME == 1)
+    const auto start = std::chrono::steady_clock::now();
+#endif
+    using T = std::iter_value_t<iterator>;
+    const auto segment{Map<T>(filename)};
+    ::sortnet::segment::validate<N, K, T>(segment.header(), layer);
+    const auto limit{std::min<std::size_t>(segment.size(), std::distance(it, end))};
+    std::copy(segment.begin(), segment.begin() + limit, it);
+#if (RECORD_IO_TIME == 1)
+    const auto stop = std::chrono::steady_clock::now();
+    this->duration += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+#endif
+
+    return static_cast<uint32_t>(limit);
+  }
+
+  // a read-only view of the records in a segment file, valid for as long as
+  // the returned segment lives
+  template <typename T> MappedSegment<T> Map(const std::string &filename) const {
+    MappedSegment<T> segment{filename};
+    ::sortnet::segment::validate<N, K, T>(segment.header());
+    return segment;
+  }
+};
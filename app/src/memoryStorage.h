@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "persistentStorage.h"
+#include "sortnet/segment.h"
+
+// MemorySegment is a read-only view of a segment kept by MemoryStorage. A view
+// shares ownership of the records, so saving the segment again while a view
+// is alive leaves the view untouched.
+template <typename T> class MemorySegment {
+private:
+  std::shared_ptr<const std::vector<T>> records{};
+
+public:
+  MemorySegment() = default;
+  explicit MemorySegment(std::shared_ptr<const std::vector<T>> records)
+      : records(std::move(records)) {}
+
+  [[nodiscard]] uint32_t size() const { return static_cast<uint32_t>(records->size()); }
+  [[nodiscard]] const T &operator[](const std::size_t i) const { return (*records)[i]; }
+  [[nodiscard]] const T *begin() const { return records->data(); }
+  [[nodiscard]] const T *end() const { return records->data() + records->size(); }
+};
+
+// MemoryStorage keeps every segment in RAM under its filename until it is
+// removed, for runs that fit in memory. Saving a segment copies the records
+// once, and Map gives read-only access to a segment without any copy. Only
+// the metrics are written to the network folder.
+template <::sortnet::concepts::NetworkRecord Net, ::sortnet::concepts::Set Set, uint8_t N,
+          uint8_t K>
+class MemoryStorage : public PersistentStorage<Net, Set, N, K> {
+private:
+  using Base = PersistentStorage<Net, Set, N, K>;
+
+  template <typename T> struct Segment {
+    ::sortnet::segment::Header header{};
+    std::shared_ptr<const std::vector<T>> records{};
+  };
+
+  mutable std::mutex mutex{};
+  std::map<std::string, Segment<Set>> sets{};
+  std::map<std::string, Segment<Net>> nets{};
+
+  template <typename T> auto &segments() {
+    if constexpr (std::is_same_v<T, Set>) {
+      return sets;
+    } else {
+      return nets;
+    }
+  }
+
+  template <typename T> const auto &segments() const {
+    if constexpr (std::is_same_v<T, Set>) {
+      return sets;
+    } else {
+      return nets;
+    }
+  }
+
+  template <typename T> Segment<T> find(const std::string &filename) const {
+    const std::lock_guard<std::mutex> lock(mutex);
+    const auto &segments{this->segments<T>()};
+    const auto it{segments.find(filename)};
+    if (it == segments.cend()) {
+      throw std::runtime_error("no segment was saved as " + filename);
+    }
+    return it->second;
+  }
+
+public:
+  using Base::Save;
+
+  template <typename II, typename II2>
+  std::string Save(const std::string &filename, uint8_t layer, II begin, II2 end) {
+    using T = std::iter_value_t<II>;
+#if (RECORD_IO_TIME == 1)
+    const auto start = std::chrono::steady_clock::now();
+#endif
+    Segment<T> segment{
+        .header = ::sortnet::segment::header<N, K>(layer, begin, end),
+        .records = std::make_shared<const std::vector<T>>(begin, end),
+    };
+    {
+      const std::lock_guard<std::mutex> lock(mutex);
+      segments<T>()[filename] = std::move(segment);
+    }
+#if (RECORD_IO_TIME == 1)
+    const auto stop = std::chrono::steady_clock::now();
+    this->duration += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+#endif
+
+    return std::string(filename);
+  }
+
+  template <typename II, typename II2>
+  std::string Save(uint8_t layer, II begin, const II2 end, const std::string &prefix = "") {
+    std::string filename{this->dir + prefix + this->createFilename(*begin, layer)};
+    return Save(filename, layer, begin, end);
+  }
+
+  template <typename iterator>
+  uint32_t Load(const std::string &filename, uint8_t layer, iterator it, iterator end) {
+    using T = std::iter_value_t<iterator>;
+#if (RECORD_IO_TIME == 1)
+    const auto start = std::chrono::steady_clock::now();
+#endif
+    const auto segment{find<T>(filename)};
+    if (segment.header.layer != layer) {
+      throw std::runtime_error("the segment belongs to another layer");
+    }
+    const auto limit{std::min<std::size_t>(segment.records->size(), std::distance(it, end))};
+    std::copy(segment.records->cbegin(), segment.records->cbegin() + limit, it);
+#if (RECORD_IO_TIME == 1)
+    const auto stop = std::chrono::steady_clock::now();
+    this->duration += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+#endif
+
+    return static_cast<uint32_t>(limit);
+  }
+
+  // a read-only view of a segment, valid for as long as the returned segment
+  // lives
+  template <typename T> MemorySegment<T> Map(const std::string &filename) const {
+    return MemorySegment<T>(find<T>(filename).records);
+  }
+
+  template <typename T> ::sortnet::segment::Header Peek(const std::string &filename) const {
+    return find<T>(filename).header;
+  }
+
+  // views of the segment stay valid
+  void Remove(const std::string &filename) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    sets.erase(filename);
+    nets.erase(filename);
+  }
+};
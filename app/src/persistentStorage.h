@@ -6,17 +6,20 @@
 #include <fstream>
 #include <iomanip>
 #include <map>
+#include <stdexcept>
 #include <string>
+#include <system_error>
 
 #include "sortnet/concepts.h"
 #include "sortnet/io.h"
 #include "sortnet/json.h"
+#include "sortnet/segment.h"
 #include "sortnet/z_environment.h"
 
-template <::sortnet::concepts::ComparatorNetwork Net, ::sortnet::concepts::Set Set, uint8_t N,
+template <::sortnet::concepts::NetworkRecord Net, ::sortnet::concepts::Set Set, uint8_t N,
           uint8_t K>
 class PersistentStorage {
-private:
+protected:
   const uint8_t width{7};
 
   const std::string PrefixNetworks{"n"};
@@ -85,21 +88,13 @@ public:
   std::string folder() { return dir; }
 
   template <typename II, typename II2>
-  std::string Save(const std::string &filename, II begin, II2 end) {
+  std::string Save(const std::string &filename, uint8_t layer, II begin, II2 end) {
 #if (RECORD_IO_TIME == 1)
     const auto start = std::chrono::steady_clock::now();
 #endif
     std::ofstream f{filename, std::ios::binary | std::ios::trunc};
     f.unsetf(std::ios_base::skipws);
-
-    // number of networks/sets
-    const int32_t distance{static_cast<int32_t>(std::distance(begin, end))};
-    ::sortnet::binary_write(f, distance);
-
-    // the actual content
-    for (; begin != end; ++begin) {
-      begin->write(f);
-    }
+    ::sortnet::segment::write<N, K>(f, layer, begin, end);
     f.close();
 #if (RECORD_IO_TIME == 1)
     const auto stop = std::chrono::steady_clock::now();
@@ -112,7 +107,7 @@ public:
   template <typename II, typename II2>
   std::string Save(uint8_t layer, II begin, const II2 end, const std::string &prefix = "") {
     std::string filename{dir + prefix + createFilename(*begin, layer)};
-    return Save(filename, begin, end);
+    return Save(filename, layer, begin, end);
   }
 
   void Save(const std::string &filename, const ::nlohmann::json &content) const {
@@ -121,24 +116,14 @@ public:
     f.close();
   }
 
-  template <typename iterator> uint32_t Load(const std::string &filename,
-                                             [[maybe_unused]] uint8_t layer, iterator it,
-                                             iterator end) {
+  template <typename iterator>
+  uint32_t Load(const std::string &filename, uint8_t layer, iterator it, iterator end) {
 #if (RECORD_IO_TIME == 1)
     const auto start = std::chrono::steady_clock::now();
 #endif
     std::ifstream f{filename, std::ios::in | std::ios::binary};
     f.unsetf(std::ios_base::skipws);
-
-    int32_t limit{};
-    ::sortnet::binary_read(f, limit);
-
-    int32_t counter{0};
-    for (; (it != end && counter < limit); ++it) {  //&& (layer <= 2 && counter < 3)
-      it->read(f);
-      ++counter;
-    }
-
+    const auto counter = ::sortnet::segment::read<N, K>(f, layer, it, end);
     f.close();
 #if (RECORD_IO_TIME == 1)
     const auto stop = std::chrono::steady_clock::now();
@@ -147,4 +132,21 @@ public:
 
     return counter;
   }
+
+  // deletes a segment that is no longer needed, if it exists
+  void Remove(const std::string &filename) {
+    std::error_code ec{};
+    std::filesystem::remove(filename, ec);
+  }
+
+  // the header of a segment of T records, without reading any of them
+  template <typename T> ::sortnet::segment::Header Peek(const std::string &filename) {
+    std::ifstream f{filename, std::ios::in | std::ios::binary};
+    ::sortnet::segment::Header header{};
+    if (!::sortnet::binary_read(f, header)) {
+      throw std::runtime_error("segment file " + filename + " has no header");
+    }
+    ::sortnet::segment::validate<N, K, T>(header);
+    return header;
+  }
 };
\ No newline at end of file
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Pool.h"
+#include "persistentStorage.h"
+#include "sortnet/segment.h"
+#include "sortnet/uring.h"
+
+// UringStorage reads and writes segment files through io_uring, and falls
+// back to pread/pwrite where io_uring is not available. A single segment is
+// saved or loaded as one submission of its header and records, and Load can
+// read the segments of a whole tile in one batch of submissions. A ring is
+// not thread safe and costs a system call and three mappings to set up, so
+// rings are reused through a pool. Records that are not trivially copyable
+// are handled by PersistentStorage.
+template <::sortnet::concepts::NetworkRecord Net, ::sortnet::concepts::Set Set, uint8_t N,
+          uint8_t K>
+class UringStorage : public PersistentStorage<Net, Set, N, K> {
+private:
+  using Base = PersistentStorage<Net, Set, N, K>;
+
+  template <typename T, typename II>
+  static constexpr bool Bulk{::sortnet::segment::recordSize<T>() != ::sortnet::segment::VariableSize
+                             && std::contiguous_iterator<II>};
+
+  // closes the file descriptor when leaving the scope
+  struct File {
+    int fd;
+    explicit File(const std::string &filename, const int flags)
+        : fd(::open(filename.c_str(), flags, 0644)) {
+      if (fd < 0) {
+        throw std::runtime_error("unable to open segment file " + filename);
+      }
+    }
+    File(const File &) = delete;
+    File &operator=(const File &) = delete;
+    ~File() { ::close(fd); }
+  };
+
+  ::sortnet::Pool<::sortnet::uring::Ring> rings{};
+
+  // a ring taken from the pool, which is returned when leaving the scope
+  class Lease {
+  private:
+    ::sortnet::Pool<::sortnet::uring::Ring> &pool;
+    ::sortnet::uring::Ring *ring;
+
+  public:
+    explicit Lease(::sortnet::Pool<::sortnet::uring::Ring> &pool) : pool(pool), ring(pool.get()) {}
+    Lease(const Lease &) = delete;
+    Lease &operator=(const Lease &) = delete;
+    ~Lease() { pool.put(ring); }
+    ::sortnet::uring::Ring *operator->() const { return ring; }
+  };
+
+  // the header and as many records as fit in [it, it + capacity)
+  template <typename T>
+  static std::array<::sortnet::uring::Operation, 2> reads(const int fd,
+                                                          ::sortnet::segment::Header &header,
+                                                          T *it, const uint32_t capacity) {
+    return {{
+        {.fd = fd, .data = &header, .length = sizeof(header), .offset = 0},
+        {.fd = fd,
+         .data = it,
+         .length = static_cast<uint32_t>(capacity * sizeof(T)),
+         .offset = ::sortnet::segment::offset<T>(0)},
+    }};
+  }
+
+  // the number of records read by the operations of reads()
+  template <typename T>
+  static uint32_t count(const std::string &filename, const uint8_t layer,
+                        const ::sortnet::segment::Header &header, const uint32_t capacity,
+                        const std::span<const ::sortnet::uring::Operation, 2> ops) {
+    if (ops[0].result != sizeof(header) || ops[1].result < 0) {
+      throw std::runtime_error("unable to read segment file " + filename);
+    }
+    ::sortnet::segment::validate<N, K, T>(header, layer);
+
+    const auto count{std::min(header.count, capacity)};
+    if (static_cast<uint64_t>(ops[1].result) < count * sizeof(T)) {
+      throw std::runtime_error("segment file " + filename + " is truncated");
+    }
+    return count;
+  }
+
+public:
+  using Base::Load;
+  using Base::Save;
+
+  template <typename II, typename II2>
+  std::string Save(const std::string &filename, uint8_t layer, II begin, II2 end) {
+    using T = std::iter_value_t<II>;
+    if constexpr (!Bulk<T, II>) {
+      return Base::Save(filename, layer, begin, end);
+    } else {
+#if (RECORD_IO_TIME == 1)
+      const auto start = std::chrono::steady_clock::now();
+#endif
+      auto header{::sortnet::segment::header<N, K>(layer, begin, end)};
+      const auto count{header.count};
+
+      const File file{filename, O_WRONLY | O_CREAT | O_TRUNC};
+      std::array<::sortnet::uring::Operation, 2> ops{{
+          {.fd = file.fd, .data = &header, .length = sizeof(header), .offset = 0, .write = true},
+          {.fd = file.fd,
+           .data = const_cast<T *>(std::to_address(begin)),
+           .length = static_cast<uint32_t>(count * sizeof(T)),
+           .offset = ::sortnet::segment::offset<T>(0),
+           .write = true},
+      }};
+      Lease(rings)->run(ops);
+      for (const auto &op : ops) {
+        if (op.result != op.length) {
+          throw std::runtime_error("unable to write segment file " + filename);
+        }
+      }
+#if (RECORD_IO_TIME == 1)
+      const auto stop = std::chrono::steady_clock::now();
+      this->duration += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+#endif
+      return std::string(filename);
+    }
+  }
+
+  template <typename II, typename II2>
+  std::string Save(uint8_t layer, II begin, const II2 end, const std::string &prefix = "") {
+    std::string filename{this->dir + prefix + this->createFilename(*begin, layer)};
+    return Save(filename, layer, begin, end);
+  }
+
+  template <typename iterator>
+  uint32_t Load(const std::string &filename, uint8_t layer, iterator it, iterator end) {
+    using T = std::iter_value_t<iterator>;
+    if constexpr (!Bulk<T, iterator>) {
+      return Base::Load(filename, layer, it, end);
+    } else {
+#if (RECORD_IO_TIME == 1)
+      const auto start = std::chrono::steady_clock::now();
+#endif
+      const auto capacity{static_cast<uint32_t>(std::distance(it, end))};
+      ::sortnet::segment::Header header{};
+
+      const File file{filename, O_RDONLY};
+      auto ops{reads(file.fd, header, std::to_address(it), capacity)};
+      Lease(rings)->run(ops);
+      const auto size{count<T>(filename, layer, header, capacity, ops)};
+#if (RECORD_IO_TIME == 1)
+      const auto stop = std::chrono::steady_clock::now();
+      this->duration += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+#endif
+      return size;
+    }
+  }
+
+  // loads many segments at once. Every segment is submitted to the ring as
+  // soon as its file is open, such that the reads of the first segments are
+  // in flight while the others are being opened, and all of them are then
+  // completed together.
+  template <typename iterator>
+  void Load(const std::span<::sortnet::segment::Request<iterator>> requests, uint8_t layer) {
+    using T = std::iter_value_t<iterator>;
+    if constexpr (!Bulk<T, iterator>) {
+      for (auto &request : requests) {
+        request.size = Base::Load(request.filename, layer, request.begin, request.end);
+      }
+    } else {
+#if (RECORD_IO_TIME == 1)
+      const auto start = std::chrono::steady_clock::now();
+#endif
+      std::deque<File> files{};
+      std::vector<::sortnet::segment::Header> headers(requests.size());
+      std::vector<std::array<::sortnet::uring::Operation, 2>> ops(requests.size());
+
+      Lease ring(rings);
+      for (std::size_t i{0}; i < requests.size(); ++i) {
+        auto &request{requests[i]};
+        const auto capacity{static_cast<uint32_t>(std::distance(request.begin, request.end))};
+        const auto &file{files.emplace_back(request.filename, O_RDONLY)};
+        ops[i] = reads(file.fd, headers[i], std::to_address(request.begin), capacity);
+        ring->submit(ops[i]);
+      }
+      ring->complete();
+
+      for (std::size_t i{0}; i < requests.size(); ++i) {
+        auto &request{requests[i]};
+        const auto capacity{static_cast<uint32_t>(std::distance(request.begin, request.end))};
+        request.size = count<T>(request.filename, layer, headers[i], capacity, ops[i]);
+      }
+#if (RECORD_IO_TIME == 1)
+      const auto stop = std::chrono::steady_clock::now();
+      this->duration += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+#endif
+    }
+  }
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// results of a round are written here, so the compiler can not discard rounds
+// whose results would otherwise be overwritten by the next one.
+inline volatile uint64_t sink{0};
+
+// run _f a few times and print the best cost per item, where _f returns the
+// number of items (permutations, sets, etc.) it processed.
+template <typename Functor> void measure(const std::string &name, Functor _f) {
+  constexpr auto rounds{5};
+
+  double best{0};
+  uint64_t items{0};
+  for (auto i{0}; i < rounds; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    items = _f();
+    const auto stop = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+    if (i == 0 || ns < best) {
+      best = ns;
+    }
+  }
+
+  std::cout << std::left << std::setw(60) << name << std::right << std::setw(12) << items
+            << " items" << std::setw(12) << std::fixed << std::setprecision(2)
+            << (best / items) << " ns/item" << std::endl;
+}
+
+void benchmarkNetwork();
+void benchmarkPermutations();
+void benchmarkSubsumption();
+void benchmarkGenerate();
+void benchmarkKernels();
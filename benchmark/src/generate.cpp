@@ -0,0 +1,58 @@
+#include <sortnet/comparator.h>
+#include <sortnet/networks/Network.h>
+#include <sortnet/sets/Bitmap.h>
+#include <sortnet/util.h>
+
+#include <random>
+#include <vector>
+
+#include "benchmark.h"
+
+namespace {
+constexpr uint8_t N{9};
+constexpr uint8_t K{25};
+using Set = ::sortnet::set::Bitmap<N, K>;
+using Net = ::sortnet::network::Network<N, K>;
+}  // namespace
+
+// the children of an output set for every comparator, as in the generation phase
+void benchmarkGenerate() {
+  std::mt19937 rng{2020};
+  const auto &comparators{::sortnet::comparator::all<N>};
+  std::vector<Set> parents(200);
+  for (std::size_t i{0}; i < parents.size(); ++i) {
+    Net net{};
+    while (net.size() < 4 + i % 12) {
+      net.push_back(comparators.at(rng() % comparators.size()));
+    }
+    ::sortnet::outputSet<N>(net, parents[i]);
+  }
+  const auto children{parents.size() * comparators.size()};
+
+  Set child{};
+  measure("N9 child output sets (insert per sequence)", [&]() {
+    uint64_t changed{0};
+    for (const auto &parent : parents) {
+      for (const auto &c : comparators) {
+        child.clear();
+        for (const auto s : parent) {
+          child.insert(std::popcount(s) - 1, c.apply(s));
+        }
+        changed += !(child == parent);
+      }
+    }
+    sink = changed;
+    return children;
+  });
+
+  measure("N9 child output sets (applyComparator)", [&]() {
+    uint64_t changed{0};
+    for (const auto &parent : parents) {
+      for (const auto &c : comparators) {
+        changed += ::sortnet::applyComparator<N>(c, parent, child);
+      }
+    }
+    sink = changed;
+    return children;
+  });
+}
@@ -0,0 +1,123 @@
+#include <sortnet/comparator.h>
+#include <sortnet/cpu.h>
+#include <sortnet/kernel.h>
+#include <sortnet/permutation.h>
+
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "benchmark.h"
+
+namespace {
+using ::sortnet::cpu::Isa;
+
+// the instruction sets this processor supports, the scalar one included
+std::vector<Isa> supported() {
+  std::vector<Isa> isas{Isa::Scalar};
+  const auto best{::sortnet::cpu::select(::sortnet::cpu::detect())};
+  for (const auto isa : {Isa::AVX2, Isa::AVX512}) {
+    if (isa <= best) {
+      isas.push_back(isa);
+    }
+  }
+  return isas;
+}
+
+// bitmaps with every sequence of a activated in b, such that the kernels have
+// to look at every word. The bitmaps are permuted in place, round after round.
+template <uint8_t N> void permutedSubsets(const ::sortnet::kernel::Table &table) {
+  constexpr std::size_t Words{((std::size_t(1) << N) + 63) / 64};
+  constexpr std::size_t Count{4096};
+  std::mt19937_64 rng{N};
+
+  std::vector<uint64_t> a(Count * Words);
+  for (auto &w : a) {
+    w = rng() & rng();
+  }
+  const std::vector<uint64_t> b(Words, ~uint64_t{0});
+
+  std::vector<std::array<::sortnet::kernel::Swap, N>> products(Count);
+  std::vector<std::size_t> counts(Count);
+  for (std::size_t i{0}; i < Count; ++i) {
+    ::sortnet::permutation::permutation_t<N> p{};
+    std::iota(p.begin(), p.end(), 0);
+    std::shuffle(p.begin(), p.end(), rng);
+    counts[i] = ::sortnet::permutation::swaps<N>(p, products[i]);
+  }
+
+  const std::string isa{::sortnet::cpu::to_string(table.isa)};
+  measure("N" + std::to_string(N) + " permuted subset (" + isa + ")", [&]() {
+    uint64_t found{0};
+    for (std::size_t i{0}; i < Count; ++i) {
+      found += table.permutedSubset(a.data() + i * Words, b.data(), Words,
+                                    products[i].data(), counts[i]);
+    }
+    sink = found;
+    return Count;
+  });
+  measure("N" + std::to_string(N) + " subset (" + isa + ")", [&]() {
+    uint64_t found{0};
+    for (std::size_t i{0}; i < Count; ++i) {
+      found += table.subset(a.data() + i * Words, b.data(), Words);
+    }
+    sink = found;
+    return Count;
+  });
+}
+}  // namespace
+
+void benchmarkKernels() {
+  constexpr uint8_t N{12};
+  constexpr std::size_t Count{4096};
+  std::mt19937_64 rng{N};
+
+  // the size metadata of ST2 and ST3, equal such that every entry is compared
+  std::vector<uint16_t> sizes(N);
+  std::vector<uint8_t> counts(N);
+  for (uint8_t i{0}; i < N; ++i) {
+    sizes[i] = static_cast<uint16_t>(rng() % 500);
+    counts[i] = static_cast<uint8_t>(rng() % 200);
+  }
+
+  // a channel major batch of every input of N channels, and random networks
+  constexpr std::size_t Lanes{(std::size_t(1) << N) / 64};
+  std::vector<uint64_t> batch(N * Lanes);
+  for (auto &w : batch) {
+    w = rng();
+  }
+  const auto &all{::sortnet::comparator::all<N>};
+  std::vector<::sortnet::Comparator> comparators(40);
+  for (auto &c : comparators) {
+    c = all.at(rng() % all.size());
+  }
+
+  std::cout << "kernels selected at startup: "
+            << ::sortnet::cpu::to_string(::sortnet::kernel::selected().isa) << std::endl;
+  for (const auto isa : supported()) {
+    const auto &table{::sortnet::kernel::kernels(isa)};
+    const std::string name{::sortnet::cpu::to_string(isa)};
+
+    permutedSubsets<9>(table);
+    permutedSubsets<12>(table);
+
+    measure("N12 ST2 and ST3 metadata compares (" + name + ")", [&]() {
+      uint64_t found{0};
+      for (std::size_t i{0}; i < Count; ++i) {
+        found += table.lessEqual16(sizes.data(), sizes.data(), N - 1)
+                 && table.lessEqual8(counts.data(), counts.data(), N);
+      }
+      sink = found;
+      return Count;
+    });
+
+    measure("N12 batch of every input through 40 comparators (" + name + ")", [&]() {
+      std::vector<uint64_t> channels(batch);
+      for (std::size_t i{0}; i < Count / 64; ++i) {
+        table.runBatch(comparators.data(), comparators.size(), channels.data(), Lanes);
+      }
+      sink = channels[0];
+      return Count / 64;
+    });
+  }
+}
@@ -0,0 +1,10 @@
+#include "benchmark.h"
+
+int main() {
+  benchmarkNetwork();
+  benchmarkPermutations();
+  benchmarkSubsumption();
+  benchmarkKernels();
+  benchmarkGenerate();
+  return 0;
+}
@@ -0,0 +1,68 @@
+#include <sortnet/comparator.h>
+#include <sortnet/networks/Network.h>
+#include <sortnet/sequence.h>
+
+#include <random>
+
+#include "benchmark.h"
+
+namespace {
+// 256 lanes per channel through the GCC/Clang vector extension
+using wide_t = uint64_t __attribute__((vector_size(32)));
+
+// evaluate a random network of K comparators on all 2^N binary inputs
+template <uint8_t N, uint8_t K> void benchmarkRun() {
+  using Net = ::sortnet::network::Network<N, K>;
+  constexpr std::size_t inputs{std::size_t(1) << N};
+
+  std::mt19937 rng{N};
+  const auto &comparators{::sortnet::comparator::all<N>};
+  Net net{};
+  while (net.size() < K) {
+    net.push_back(comparators.at(rng() % comparators.size()));
+  }
+
+  const std::string name{"N" + std::to_string(N) + " network on every input"};
+  measure(name + " (run)", [&]() {
+    uint64_t found{0};
+    for (::sortnet::sequence_t s{0}; s < inputs; ++s) {
+      found += net.run(s);
+    }
+    sink = found;
+    return inputs;
+  });
+
+  measure(name + " (runBatch, 64 lanes)", [&]() {
+    uint64_t found{0};
+    for (std::size_t b{0}; b < ::sortnet::sequence::binary::batches<N>(); ++b) {
+      auto channels{::sortnet::sequence::binary::batch<N>(b)};
+      net.runBatch(channels);
+      found += channels[0];
+    }
+    sink = found;
+    return inputs;
+  });
+
+  measure(name + " (runBatch, 256 lanes)", [&]() {
+    uint64_t found{0};
+    for (std::size_t b{0}; b < ::sortnet::sequence::binary::batches<N>(); b += 4) {
+      std::array<wide_t, N> channels{};
+      for (std::size_t i{0}; i < 4; ++i) {
+        const auto narrow{::sortnet::sequence::binary::batch<N>(b + i)};
+        for (uint8_t c{0}; c < N; ++c) {
+          channels[c][i] = narrow[c];
+        }
+      }
+      net.runBatch(channels);
+      found += channels[0][0] + channels[0][3];
+    }
+    sink = found;
+    return inputs;
+  });
+}
+}  // namespace
+
+void benchmarkNetwork() {
+  benchmarkRun<9, 25>();
+  benchmarkRun<12, 39>();
+}
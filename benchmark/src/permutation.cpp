@@ -0,0 +1,105 @@
+#include <sortnet/permutation.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "benchmark.h"
+
+namespace reference {
+// the stack based enumerator that permutation::generate replaced, kept
+// around to show the cost per permutation before and after.
+template <uint8_t N>
+bool generate(const std::array<::sortnet::sequence_t, N> &constraints,
+              const std::function<bool(::sortnet::permutation::permutation_t<N> &)> &__f) {
+  std::vector<std::vector<uint8_t>> stack{};
+  ::sortnet::permutation::permutation_t<N> p{};
+
+  for (uint8_t i{0}; i < N; ++i) {
+    if (((constraints.at(0) >> i) & 0b1) == 1) {
+      stack.push_back({i});
+    }
+  }
+
+  while (!stack.empty()) {
+    const auto w{stack.at(stack.size() - 1)};
+    stack.pop_back();
+
+    if (w.size() == N) {
+      std::copy(w.cbegin(), w.cend(), p.begin());
+      if (__f(p)) {
+        return true;
+      }
+      continue;
+    }
+
+    const auto constraint{constraints.at(w.size())};
+    for (uint8_t i{0}; i < N; ++i) {
+      if (((constraint >> i) & 0b1) == 0) {
+        continue;
+      }
+      if (std::find(w.cbegin(), w.cend(), i) != w.cend()) {
+        continue;
+      }
+
+      auto w2(w);
+      w2.push_back(i);
+      stack.push_back(w2);
+    }
+  }
+
+  return false;
+}
+}  // namespace reference
+
+template <uint8_t N> void benchmarkPermutations(const std::string &name,
+                                                const ::sortnet::permutation::constraints_t<N> &c) {
+  uint64_t checksum{0};
+  auto visit = [&](const ::sortnet::permutation::permutation_t<N> &p) {
+    checksum += p[0];
+    return false;
+  };
+
+  uint64_t referenceChecksum{0};
+  measure("N" + std::to_string(N) + " " + name + " (vector stack, std::function)", [&]() {
+    uint64_t permutations{0};
+    reference::generate<N>(c, [&](auto &p) {
+      ++permutations;
+      return visit(p);
+    });
+    return permutations;
+  });
+  std::swap(checksum, referenceChecksum);
+
+  measure("N" + std::to_string(N) + " " + name + " (permutation::generate)", [&]() {
+    uint64_t permutations{0};
+    ::sortnet::permutation::generate<N>(c, [&](auto &p) {
+      ++permutations;
+      return visit(p);
+    });
+    return permutations;
+  });
+
+  if (checksum != referenceChecksum) {
+    std::cout << "mismatch between the enumerators" << std::endl;
+  }
+}
+
+void benchmarkPermutations() {
+  {
+    constexpr uint8_t N{9};
+    ::sortnet::permutation::constraints_t<N> c{};
+    ::sortnet::permutation::clear<N>(c);
+    benchmarkPermutations<N>("unconstrained", c);
+  }
+  {
+    // two channels fixed and the remaining split into two groups,
+    // similar to the matrices produced by the partition masks
+    constexpr uint8_t N{9};
+    const ::sortnet::permutation::constraints_t<N> c{
+        0b000000001, 0b011111110, 0b011111110, 0b011111110, 0b011111110,
+        0b011111110, 0b011111110, 0b011111110, 0b100000000,
+    };
+    benchmarkPermutations<N>("constrained", c);
+  }
+}
@@ -0,0 +1,150 @@
+#include <sortnet/comparator.h>
+#include <sortnet/networks/Network.h>
+#include <sortnet/permutation.h>
+#include <sortnet/sequence.h>
+#include <sortnet/sets/Bitmap.h>
+
+#include <random>
+#include <vector>
+
+#include "benchmark.h"
+
+namespace {
+constexpr uint8_t N{9};
+constexpr uint8_t K{25};
+using Set = ::sortnet::set::Bitmap<N, K>;
+using Net = ::sortnet::network::Network<N, K>;
+
+// output sets of pseudo random networks of the given size
+std::vector<Set> outputSets(const std::size_t count, const std::size_t size) {
+  std::mt19937 rng{1337};
+  const auto &comparators{::sortnet::comparator::all<N>};
+
+  std::vector<Set> sets(count);
+  for (auto &set : sets) {
+    Net net{};
+    while (net.size() < size) {
+      const auto c{comparators.at(rng() % comparators.size())};
+      if (!(net.back() == c)) {
+        net.push_back(c);
+      }
+    }
+
+    set.clear();
+    for (const auto s : ::sortnet::sequence::binary::all<N>) {
+      set.insert(std::popcount(s) - 1, net.run(s));
+    }
+    set.computeMeta();
+  }
+  return sets;
+}
+
+// the pairs that pass ST1, ST2, ST3 and have a non empty constraint matrix
+struct Candidate {
+  const Set *a;
+  const Set *b;
+  ::sortnet::permutation::constraints_t<N> constraints;
+};
+
+std::vector<Candidate> candidates(const std::vector<Set> &sets) {
+  std::vector<Candidate> pairs{};
+  for (const auto &a : sets) {
+    for (const auto &b : sets) {
+      if (&a == &b || !::sortnet::permutation::ST1(a, b) || !::sortnet::permutation::ST2(a, b)
+          || !::sortnet::permutation::ST3(a, b)) {
+        continue;
+      }
+
+      Candidate c{&a, &b, {}};
+      ::sortnet::permutation::clear<N>(c.constraints);
+      ::sortnet::permutation::constraints<N>(c.constraints, a, b);
+      if (::sortnet::permutation::valid_fast<N>(c.constraints)) {
+        pairs.push_back(c);
+      }
+    }
+  }
+  return pairs;
+}
+
+// the sequence by sequence test, as used by sets that are not bitmaps
+bool perSequence(const ::sortnet::permutation::permutation_t<N> &p, const Set &a, const Set &b) {
+  for (const auto s : a) {
+    if (!b.contains(::sortnet::permutation::apply<N>(p, s))) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+void benchmarkSubsumption() {
+  for (const std::size_t size : {6, 10}) {
+    const auto sets{outputSets(300, size)};
+    const auto pairs{candidates(sets)};
+    const std::string name{"N9 subsumption search, networks of size " + std::to_string(size)};
+
+    // order dependent hash of the outcomes, such that every pair must be evaluated
+    uint64_t found{0};
+    measure(name + " (complete permutations, per sequence)", [&]() {
+      found = 0;
+      for (const auto &pair : pairs) {
+        const bool subsumes = ::sortnet::permutation::generate<N>(
+            pair.constraints, [&](const auto &p) { return perSequence(p, *pair.a, *pair.b); });
+        found = found * 31 + subsumes;
+      }
+      sink = found;
+      return pairs.size();
+    });
+    const auto expected{found};
+
+    measure(name + " (complete permutations, word parallel)", [&]() {
+      found = 0;
+      for (const auto &pair : pairs) {
+        const bool subsumes = ::sortnet::permutation::generate<N>(
+            pair.constraints,
+            [&](const auto &p) { return ::sortnet::permutation::subsumes<N>(p, *pair.a, *pair.b); });
+        found = found * 31 + subsumes;
+      }
+      sink = found;
+      return pairs.size();
+    });
+    bool agree{found == expected};
+
+    measure(name + " (early rejection)", [&]() {
+      found = 0;
+      for (const auto &pair : pairs) {
+        const bool subsumes = ::sortnet::permutation::subsumes<N>(
+            pair.constraints, *pair.a, *pair.b, [](const auto &) { return true; });
+        found = found * 31 + subsumes;
+      }
+      sink = found;
+      return pairs.size();
+    });
+
+    uint64_t infeasible{0};
+    measure(name + " (early rejection, propagated + matching)", [&]() {
+      found = 0;
+      infeasible = 0;
+      for (const auto &pair : pairs) {
+        auto constraints{pair.constraints};
+        bool subsumes{false};
+        if (::sortnet::permutation::propagate<N>(constraints)
+            && ::sortnet::permutation::matching<N>(constraints)) {
+          subsumes = ::sortnet::permutation::subsumes<N>(constraints, *pair.a, *pair.b,
+                                                         [](const auto &) { return true; });
+        } else {
+          ++infeasible;
+        }
+        found = found * 31 + subsumes;
+      }
+      sink = found;
+      return pairs.size();
+    });
+    std::cout << "  infeasible constraint matrices: " << infeasible << "/" << pairs.size()
+              << std::endl;
+
+    if (!agree || found != expected) {
+      std::cout << "mismatch between the subsumption searches" << std::endl;
+    }
+  }
+}
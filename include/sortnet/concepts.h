@@ -19,6 +19,17 @@ template <class T> concept ComparatorNetwork
   ->std::same_as<::sortnet::sequence_t>;
 };
 
+// what the generate and prune phases need from a stored network, which is
+// either a complete ComparatorNetwork or a record of the last comparator only
+template <class T> concept NetworkRecord = requires(T net, ::sortnet::Comparator c) {
+  { net.id }
+  ->std::convertible_to<uint64_t>;
+  { net.back() }
+  ->std::same_as<::sortnet::Comparator>;
+  {net.push_back(c)};
+  {net.clear()};
+};
+
 template <class T> concept Set = requires(T set, T other, uint8_t k, ::sortnet::sequence_t s) {
   { set.size() }
   ->std::same_as<std::size_t>;
@@ -32,4 +43,11 @@ template <class T> concept Set = requires(T set, T other, uint8_t k, ::sortnet::
   {set.clear()};
   {set.computeMeta()};
 };
+
+// a Set backed by a bitmap of 2^N bits, where bit s tells whether the binary
+// sequence s is part of the set. The words can be processed directly.
+template <class T> concept WordSet = Set<T> && requires(const T set) {
+  { set.data() }
+  ->std::same_as<const typename T::words_t &>;
+};
 }  // namespace sortnet::concepts
\ No newline at end of file
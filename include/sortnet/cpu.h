@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#  define SORTNET_X86_CPUID 1
+#else
+#  define SORTNET_X86_CPUID 0
+#endif
+
+namespace sortnet::cpu {
+// the instruction sets there are kernels for, from least to most capable, see
+// kernel::Table. The binary is built for the baseline architecture and picks
+// the most capable supported one once at startup.
+enum class Isa : uint8_t { Scalar, AVX2, AVX512 };
+
+struct Features {
+  bool avx2{false};
+  bool bmi2{false};
+  bool avx512{false};  // foundation, byte/word and vector length instructions
+};
+
+// query cpuid of the processor running this binary
+Features detect();
+
+Isa select(const Features &features);
+
+std::string to_string(Isa isa);
+}  // namespace sortnet::cpu
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <sortnet/comparator.h>
+#include <sortnet/cpu.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sortnet::kernel {
+// an exchange of channel a and b (a < b) of every sequence in a bitmap, see
+// permutation::apply
+struct Swap {
+  uint8_t a{0};
+  uint8_t b{0};
+};
+
+// the hot loops of generating and pruning, implemented once per instruction
+// set. Bitmaps are arrays of 64 bit words, see set::Bitmap. The wide kernels
+// only pay off for bitmaps of at least MinWords words and batches of at least
+// MinWords lanes, smaller ones are left to the inlined scalar code.
+struct Table {
+  static constexpr std::size_t MinWords{4};
+
+  ::sortnet::cpu::Isa isa{::sortnet::cpu::Isa::Scalar};
+
+  // whether every bit of a is activated in b
+  bool (*subset)(const uint64_t *a, const uint64_t *b, std::size_t words){nullptr};
+
+  // applies the channel swaps to a in place, and then tests it as a subset
+  // of b, see permutation::subsumes
+  bool (*permutedSubset)(uint64_t *a, const uint64_t *b, std::size_t words, const Swap *swaps,
+                         std::size_t count){nullptr};
+
+  // whether a[i] <= b[i] for every i < n, see permutation::ST2 and ST3
+  bool (*lessEqual8)(const uint8_t *a, const uint8_t *b, std::size_t n){nullptr};
+  bool (*lessEqual16)(const uint16_t *a, const uint16_t *b, std::size_t n){nullptr};
+
+  // runs the comparators on a channel major batch of channels * lanes words,
+  // where channel c starts at word c * lanes, see network::Network::runBatch
+  void (*runBatch)(const ::sortnet::Comparator *comparators, std::size_t count,
+                   uint64_t *channels, std::size_t lanes){nullptr};
+};
+
+// the kernels of an instruction set, which must be supported by the processor
+const Table &kernels(::sortnet::cpu::Isa isa);
+
+// the kernels of the most capable instruction set of this processor, selected
+// on first use
+const Table &selected();
+}  // namespace sortnet::kernel
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <sortnet/cpu.h>
 #include <sortnet/json.h>
+#include <sortnet/kernel.h>
 #include <sortnet/util.h>
 
 #include <array>
@@ -35,6 +37,7 @@ public:
 
   uint64_t ST1Calls{0};
   uint64_t ST1{0};
+  uint64_t ST1Avoided{0};
   uint64_t ST2Calls{0};
   uint64_t ST2{0};
   uint64_t ST3Calls{0};
@@ -54,6 +57,18 @@ public:
   uint64_t Subsumptions{0};
 
   uint64_t Permutations{0};
+  uint64_t IdentitySubsumptions{0};
+  uint64_t PermutationCacheHits{0};
+  uint64_t PermutationCacheMisses{0};
+
+  uint64_t StorageHits{0};
+  uint64_t StorageMisses{0};
+  uint64_t StorageSpilledBytes{0};
+
+  uint64_t SegmentPairs{0};
+  uint64_t SegmentPairsSkipped{0};
+  uint64_t SegmentPairsOneWay{0};
+  uint64_t SegmentLoadsSkipped{0};
 
   double DurationGenerating{0};
   double DurationPruning{0};
@@ -146,6 +161,12 @@ public:
     j["layers"] = metrics;
     j["file_limit"] = fileLimit;
 
+    const auto features{::sortnet::cpu::detect()};
+    j["cpu"]["avx2"] = features.avx2;
+    j["cpu"]["bmi2"] = features.bmi2;
+    j["cpu"]["avx512"] = features.avx512;
+    j["cpu"]["kernels"] = ::sortnet::cpu::to_string(::sortnet::kernel::selected().isa);
+
     std::time_t result = std::time(nullptr);
     j["date"] = std::asctime(std::localtime(&result));
     j["epoch"] = result;
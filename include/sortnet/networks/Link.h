@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../z_environment.h"
+#include "sortnet/comparator.h"
+#include "sortnet/io.h"
+
+namespace sortnet {
+namespace network {
+// Link stores a network as the comparator appended to its parent network, such
+// that a record has the same size in every layer. The complete network is
+// recovered by following the parent IDs back to the empty network of layer 0.
+template <uint8_t N, uint8_t K> class Link {
+public:
+  uint64_t id{0};
+  uint64_t parent{0};
+  ::sortnet::Comparator comparator{};
+
+  constexpr Link() = default;
+  constexpr Link(const Link &rhs) = default;
+  constexpr Link &operator=(const Link &rhs) = default;
+
+  [[nodiscard]] constexpr bool empty() const { return comparator.empty(); }
+
+  constexpr void clear() {
+    id = 0;
+    parent = 0;
+    comparator = ::sortnet::Comparator(0, 0);
+  }
+
+  constexpr ::sortnet::Comparator back() const { return comparator; }
+
+  // turns this record into a child of the current network, the caller must
+  // assign the child its own id afterwards.
+  constexpr void push_back(const ::sortnet::Comparator c) {
+    parent = id;
+    comparator = c;
+  }
+
+  // serialize
+  void write(std::ostream &stream) const {
+    ::sortnet::binary_write(stream, id);
+    ::sortnet::binary_write(stream, parent);
+    ::sortnet::binary_write(stream, comparator);
+  }
+
+  void read(std::istream &stream) {
+    ::sortnet::binary_read(stream, id);
+    ::sortnet::binary_read(stream, parent);
+    comparator.read(stream);
+  }
+};
+}  // namespace network
+}  // namespace sortnet
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <array>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "../z_environment.h"
 #include "sortnet/comparator.h"
 #include "sortnet/io.h"
+#include "sortnet/kernel.h"
+#include "sortnet/sequence.h"
 
 namespace sortnet {
 namespace network {
@@ -71,6 +75,57 @@ public:
     return s;
   };
 
+  // runs every lane of a channel major batch at once, see sequence::binary::batch_t.
+  // A comparator moves the activated bit of channel from to channel to, which
+  // is one OR and one AND per comparator for all lanes. Word can be any type
+  // with bitwise operators, eg. a vector extension type for wider batches.
+  template <typename Word> constexpr void runBatch(std::array<Word, N> &channels) const {
+    for (const auto &c : comparators) {
+      const Word to{channels[c.to]};
+      channels[c.to] = to | channels[c.from];
+      channels[c.from] = to & channels[c.from];
+    }
+  }
+
+  // whether the network sorts every one of the 2^N binary inputs. From
+  // MinWords batches on, all of them are run at once by the kernel of the
+  // processor, see kernel::Table.
+  [[nodiscard]] constexpr bool sorts() const {
+    constexpr std::size_t Batches{::sortnet::sequence::binary::batches<N>()};
+    if (Batches >= ::sortnet::kernel::Table::MinWords && !std::is_constant_evaluated()) {
+      std::vector<uint64_t> channels(N * Batches);
+      for (std::size_t b{0}; b < Batches; ++b) {
+        const auto batch{::sortnet::sequence::binary::batch<N>(b)};
+        for (uint8_t c{0}; c < N; ++c) {
+          channels[c * Batches + b] = batch[c];
+        }
+      }
+      ::sortnet::kernel::selected().runBatch(comparators.data(), comparators.size(),
+                                             channels.data(), Batches);
+      for (uint8_t c{1}; c < N; ++c) {
+        for (std::size_t b{0}; b < Batches; ++b) {
+          if ((channels[c * Batches + b] & ~channels[(c - 1) * Batches + b]) != 0) {
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+
+    for (std::size_t b{0}; b < ::sortnet::sequence::binary::batches<N>(); ++b) {
+      auto channels{::sortnet::sequence::binary::batch<N>(b)};
+      runBatch(channels);
+
+      // sorted sequences have their activated bits in the lowest channels
+      for (uint8_t c{1}; c < N; ++c) {
+        if ((channels[c] & ~channels[c - 1]) != 0) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
   // iterators for the comparators
   using const_iterator = typename std::vector<::sortnet::Comparator>::const_iterator;
 //  using iterator = typename std::vector<::sortnet::Comparator>::iterator;
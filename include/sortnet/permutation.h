@@ -1,13 +1,17 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
-#include <functional>
+#include <bit>
+#include <numeric>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "sequence.h"
 #include "sortnet/concepts.h"
+#include "sortnet/kernel.h"
 #include "z_environment.h"
 
 namespace sortnet::permutation {
@@ -36,6 +40,83 @@ template <uint8_t N> constexpr bool valid_fast(const constraints_t<N> &constrain
   return true;
 }
 
+// a row with a single possibility forces that channel, which is then removed
+// from every other row. Repeats until no new rows are forced and returns false
+// when a row ends up without any possibilities.
+template <uint8_t N> constexpr bool propagate(constraints_t<N> &constraints) {
+  sequence_t forced{0};
+  bool changed{true};
+  while (changed) {
+    changed = false;
+    for (uint8_t i{0}; i < N; ++i) {
+      const sequence_t channel{constraints[i]};
+      if (channel == 0) {
+        return false;
+      }
+      if (!std::has_single_bit(channel) || (forced & channel) != 0) {
+        continue;
+      }
+
+      forced |= channel;
+      changed = true;
+      for (uint8_t j{0}; j < N; ++j) {
+        if (j != i) {
+          constraints[j] &= ~channel;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+namespace detail {
+// find an augmenting path from the given row, see Kuhn's algorithm
+template <uint8_t N> constexpr bool augment(const constraints_t<N> &constraints,
+                                            std::array<int8_t, N> &owners, sequence_t &visited,
+                                            const uint8_t row) {
+  sequence_t candidates{constraints[row] & ~visited};
+  while (candidates != 0) {
+    const auto channel{std::countr_zero(candidates)};
+    visited |= sequence_t(1) << channel;
+
+    const auto owner{owners[channel]};
+    if (owner < 0 || augment<N>(constraints, owners, visited, owner)) {
+      owners[channel] = static_cast<int8_t>(row);
+      return true;
+    }
+    candidates = constraints[row] & ~visited;
+  }
+  return false;
+}
+}  // namespace detail
+
+// whether every position can be given a distinct channel, ie. Hall's condition
+// holds and generate can produce at least one permutation.
+template <uint8_t N> constexpr bool matching(const constraints_t<N> &constraints) {
+  std::array<int8_t, N> owners{};
+  owners.fill(-1);
+  for (uint8_t row{0}; row < N; ++row) {
+    sequence_t visited{0};
+    if (!detail::augment<N>(constraints, owners, visited, row)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// whether every position of the permutation is mapped to a channel its
+// constraints allow.
+template <uint8_t N>
+constexpr bool allowed(const constraints_t<N> &constraints, const permutation_t<N> &p) {
+  for (uint8_t i{0}; i < N; ++i) {
+    if (((constraints[i] >> p[i]) & 0b1) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
 template <uint8_t N> permutation_t<N> createPaper(const std::array<uint8_t, N> &pArr) {
   permutation_t<N> p{};
   for (auto i{0}; i < N; ++i) {
@@ -61,53 +142,48 @@ constexpr void apply(const permutation_t<N> &p, set_t &set) {
   set.clear();
   for (const sequence_t s : sequences) {
     const sequence_t permuted = apply<N>(p, s);
-    const uint8_t k = std::popcount(permuted - 1);
+    const uint8_t k = std::popcount(permuted) - 1;
     set.insert(k, permuted);
   }
 }
 
-template <uint8_t N> bool generate(const std::array<sequence_t, N> &constraints,
-                                   const std::function<bool(permutation_t<N> &)> &__f) {
-  std::vector<std::vector<uint8_t>> stack{};
-  permutation_t<N> p{};
-
-  // add the possibilities for the first position
-  for (uint8_t i{0}; i < N; ++i) {
-    if (((constraints.at(0) >> i) & 0b1) == 1) {
-      stack.push_back({i});
-    }
-  }
-
-  // backtrack permutations from "perfect matching"
-  while (!stack.empty()) {
-    const auto w{stack.at(stack.size() - 1)};
-    stack.pop_back();
+namespace detail {
+// fixes the channel of position Pos and recurses into the next position.
+// Candidates are visited from the highest channel to the lowest, which keeps
+// the order of the previous stack based implementation. A branch is cut as
+// soon as __prefix rejects the positions [0, Pos] fixed so far.
+template <uint8_t N, uint8_t Pos, typename Prefix, typename Functor>
+constexpr bool generate(const constraints_t<N> &constraints, permutation_t<N> &p,
+                        const sequence_t used, Prefix &__prefix, Functor &__f) {
+  if constexpr (Pos == N) {
+    return __f(p);
+  } else {
+    sequence_t candidates{constraints[Pos] & ~used & sequence::binary::mask<N>};
+    while (candidates != 0) {
+      const auto i{std::bit_width(candidates) - 1};
+      const sequence_t bit{sequence_t(1) << i};
+      candidates ^= bit;
 
-    if (w.size() == N) {
-      std::copy(w.cbegin(), w.cend(), p.begin());
-      if (__f(p)) {
-        return true;
-      }
-      continue;
-    }
-
-    // add next constraints
-    const auto constraint{constraints.at(w.size())};
-    for (uint8_t i{0}; i < N; ++i) {
-      if (((constraint >> i) & 0b1) == 0) {
+      p[Pos] = static_cast<int8_t>(i);
+      if (!__prefix(p, Pos + 1)) {
         continue;
       }
-      if (std::find(w.cbegin(), w.cend(), i) != w.cend()) {
-        continue;
+      if (generate<N, Pos + 1>(constraints, p, used | bit, __prefix, __f)) {
+        return true;
       }
-
-      auto w2(w);
-      w2.push_back(i);
-      stack.push_back(w2);
     }
+    return false;
   }
+}
+}  // namespace detail
 
-  return false;
+// backtrack permutations from "perfect matching" and call __f for every
+// complete permutation. Stops and returns true as soon as __f does.
+template <uint8_t N, typename Functor>
+constexpr bool generate(const constraints_t<N> &constraints, Functor &&__f) {
+  permutation_t<N> p{};
+  auto everyPrefix = [](const permutation_t<N> &, const uint8_t) { return true; };
+  return detail::generate<N, 0>(constraints, p, 0, everyPrefix, __f);
 }
 
 template <uint8_t N> constexpr void constraints(constraints_t<N> &constraints,
@@ -139,6 +215,9 @@ template <::sortnet::concepts::Set Set> constexpr bool ST2(const Set &setA, cons
   const auto &a{setA.metadata};
   const auto &b{setB.metadata};
 
+  if (!std::is_constant_evaluated()) {
+    return ::sortnet::kernel::selected().lessEqual16(a.sizes.data(), b.sizes.data(), a.size);
+  }
   for (auto i{0}; i < a.size; ++i) {
     if (a.sizes.at(i) > b.sizes.at(i)) {
       return false;
@@ -152,6 +231,11 @@ template <::sortnet::concepts::Set Set> constexpr bool ST3(const Set &setA, cons
   const auto &a{setA.metadata};
   const auto &b{setB.metadata};
 
+  if (!std::is_constant_evaluated()) {
+    const auto &kernels{::sortnet::kernel::selected()};
+    return kernels.lessEqual8(a.onesCount.data(), b.onesCount.data(), a.size)
+           && kernels.lessEqual8(a.zerosCount.data(), b.zerosCount.data(), a.size);
+  }
   for (auto i{0}; i < a.size; ++i) {
     if (a.onesCount.at(i) > b.onesCount.at(i)) {
       return false;
@@ -164,17 +248,248 @@ template <::sortnet::concepts::Set Set> constexpr bool ST3(const Set &setA, cons
   return true;
 }
 
+namespace detail {
+// bit x of a word is activated in channelMasks[c] when bit c of x is
+using word_t = uint64_t;
+constexpr std::array<word_t, 6> channelMasks{
+    0xAAAAAAAAAAAAAAAA, 0xCCCCCCCCCCCCCCCC, 0xF0F0F0F0F0F0F0F0,
+    0xFF00FF00FF00FF00, 0xFFFF0000FFFF0000, 0xFFFFFFFF00000000,
+};
+
+// exchanges channel a and b (a < b) of every sequence in a bitmap of size
+// words, such that bit x ends up at the position of x with bit a and b
+// swapped. Channels below 6 address bits within a word, the others address
+// words.
+constexpr void swapChannels(word_t *words, const std::size_t size, const uint8_t a,
+                            const uint8_t b) {
+  if (b < 6) {
+    const uint8_t delta = (1 << b) - (1 << a);
+    const word_t mask{channelMasks[a] & ~channelMasks[b]};
+    for (std::size_t i{0}; i < size; ++i) {
+      word_t &w{words[i]};
+      const word_t t{((w >> delta) ^ w) & mask};
+      w ^= t ^ (t << delta);
+    }
+  } else if (a < 6) {
+    const uint8_t delta = 1 << a;
+    const std::size_t step{std::size_t(1) << (b - 6)};
+    for (std::size_t lo{0}; lo + step < size; ++lo) {
+      if ((lo & step) != 0) {
+        continue;
+      }
+      word_t &high{words[lo + step]};
+      const word_t t{((words[lo] >> delta) ^ high) & ~channelMasks[a]};
+      high ^= t;
+      words[lo] ^= t << delta;
+    }
+  } else {
+    const std::size_t stepA{std::size_t(1) << (a - 6)};
+    const std::size_t stepB{std::size_t(1) << (b - 6)};
+    for (std::size_t i{0}; i + stepB < size; ++i) {
+      if ((i & (stepA | stepB)) == 0) {
+        std::swap(words[i + stepA], words[i + stepB]);
+      }
+    }
+  }
+}
+}  // namespace detail
+
+// the channel swaps, at most N-1, whose product permutes every sequence of a
+// bitmap by p. Returns the number of swaps.
+template <uint8_t N>
+constexpr std::size_t swaps(const permutation_t<N> &p,
+                            std::array<::sortnet::kernel::Swap, N> &product) {
+  // at[c] is the original channel currently found at channel c, and pos its inverse
+  permutation_t<N> at{};
+  std::iota(at.begin(), at.end(), 0);
+  permutation_t<N> pos{at};
+  std::size_t count{0};
+  for (int8_t i{0}; i < N; ++i) {
+    const int8_t from{pos[i]};
+    const int8_t to{p[i]};
+    if (from == to) {
+      continue;
+    }
+    product[count++] = {static_cast<uint8_t>(std::min(from, to)),
+                        static_cast<uint8_t>(std::max(from, to))};
+    const int8_t other{at[to]};
+    at[from] = other;
+    pos[other] = from;
+    at[to] = i;
+    pos[i] = to;
+  }
+  return count;
+}
+
+// permutes every sequence of a bitmap at once, see swaps
+template <uint8_t N, std::size_t Words>
+constexpr void apply(const permutation_t<N> &p, std::array<detail::word_t, Words> &words) {
+  std::array<::sortnet::kernel::Swap, N> product{};
+  const auto count{swaps<N>(p, product)};
+  for (std::size_t i{0}; i < count; ++i) {
+    detail::swapChannels(words.data(), Words, product[i].a, product[i].b);
+  }
+}
+
+// word parallel subsumption of two bitmaps: a is permuted as a whole and then
+// tested as a subset of b, 64 sequences at the time. Bitmaps of MinWords words
+// or more are handed to the kernel of the processor, see kernel::Table.
+template <uint8_t N, std::size_t Words>
+constexpr bool subsumes(const permutation_t<N> &p, std::array<detail::word_t, Words> a,
+                        const std::array<detail::word_t, Words> &b) {
+  if (Words >= ::sortnet::kernel::Table::MinWords && !std::is_constant_evaluated()) {
+    std::array<::sortnet::kernel::Swap, N> product{};
+    const auto count{swaps<N>(p, product)};
+    return ::sortnet::kernel::selected().permutedSubset(a.data(), b.data(), Words,
+                                                        product.data(), count);
+  }
+
+  apply<N>(p, a);
+  for (std::size_t i{0}; i < Words; ++i) {
+    if ((a[i] & ~b[i]) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
 template <uint8_t N, ::sortnet::concepts::Set Set>
 constexpr bool subsumes(const permutation_t<N> &p, const Set &setA, const Set &setB) {
+  if constexpr (::sortnet::concepts::WordSet<Set>) {
+    return subsumes<N>(p, setA.data(), setB.data());
+  }
+
   for (const sequence_t s : setA) {
+    // a permutation keeps the number of activated bits, so only the
+    // partition k of setB needs to be probed
+    const int8_t k = std::popcount(s) - 1;
     const auto permuted{permutation::apply<N>(p, s)};
-    if (!setB.contains(permuted)) {  // O(setB.size())
+    if (!setB.contains(k, permuted)) {
       return false;
     }
   }
   return true;
 }
 
+// applies a permutation where only the positions of the activated bits in s
+// need to be fixed.
+template <uint8_t N> constexpr sequence_t applyPartial(const permutation_t<N> &p, sequence_t s) {
+  sequence_t product{0};
+  while (s != 0) {
+    const auto i{std::countr_zero(s)};
+    s &= s - 1;
+    product |= sequence_t(1) << p[i];
+  }
+  return product;
+}
+
+// the sequences of setA grouped by their highest activated bit, such that the
+// sequences in [offsets[d-1], offsets[d]) can be permuted once the first d
+// positions are fixed. Within a group, sequences from the smallest partitions
+// of setB come first, as those are the most likely to be missing.
+// The order lives on the stack, as it is built for every pair of sets that
+// reaches the permutation search; only the first count sequences are set.
+template <uint8_t N> class PrefixOrder {
+public:
+  std::array<sequence_t, (std::size_t(1) << N)> seqs;
+  uint32_t count{0};
+  std::array<uint32_t, N + 1> offsets{};
+
+  template <::sortnet::concepts::Set Set> PrefixOrder(const Set &setA, const Set &setB) {
+    constexpr uint8_t partitions{N - 1};
+
+    // rank the partitions of setB from smallest to largest
+    const auto &sizes{setB.metadata.sizes};
+    std::array<uint8_t, partitions> byRarity{};
+    std::iota(byRarity.begin(), byRarity.end(), 0);
+    std::stable_sort(byRarity.begin(), byRarity.end(),
+                     [&](const uint8_t a, const uint8_t b) { return sizes[a] < sizes[b]; });
+    std::array<uint8_t, partitions> rank{};
+    for (uint8_t i{0}; i < partitions; ++i) {
+      rank[byRarity[i]] = i;
+    }
+
+    // counting sort on (highest activated bit, partition rank)
+    auto bucket = [&](const sequence_t s) {
+      return (std::bit_width(s) - 1) * partitions + rank[std::popcount(s) - 1];
+    };
+    std::array<uint32_t, N * partitions + 1> buckets{};
+    for (const sequence_t s : setA) {
+      ++buckets[bucket(s) + 1];
+    }
+    std::partial_sum(buckets.cbegin(), buckets.cend(), buckets.begin());
+    for (uint8_t level{1}; level <= N; ++level) {
+      offsets[level] = buckets[level * partitions];
+    }
+
+    count = buckets.back();
+    for (const sequence_t s : setA) {
+      seqs[buckets[bucket(s)]++] = s;
+    }
+  }
+};
+
+// early rejection mode of generate: every sequence of setA is tested against
+// setB as soon as the positions of its activated bits are fixed, and the branch
+// is cut on the first sequence that is missing. __f is called for every
+// complete permutation, each of which is a witness of setA subsuming setB.
+template <uint8_t N, ::sortnet::concepts::Set Set, typename Functor>
+bool subsumes(const constraints_t<N> &constraints, const Set &setA, const Set &setB,
+              Functor &&__f) {
+  const PrefixOrder<N> order(setA, setB);
+  auto prefix = [&](const permutation_t<N> &p, const uint8_t depth) {
+    for (auto i{order.offsets[depth - 1]}; i < order.offsets[depth]; ++i) {
+      const sequence_t s{order.seqs[i]};
+      const int8_t k = std::popcount(s) - 1;
+      if (!setB.contains(k, applyPartial<N>(p, s))) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  permutation_t<N> p{};
+  return detail::generate<N, 0>(constraints, p, 0, prefix, __f);
+}
+
+// the most recently used permutations, ordered from most to least recent.
+template <uint8_t N, std::size_t Capacity> class Recent {
+private:
+  std::array<permutation_t<N>, Capacity> entries{};
+  std::size_t length{0};
+
+public:
+  [[nodiscard]] constexpr std::size_t size() const { return length; }
+
+  // returns true on the first permutation accepted by __f, which then
+  // becomes the most recent one.
+  template <typename Functor> constexpr bool find(Functor &&__f) {
+    for (std::size_t i{0}; i < length; ++i) {
+      if (__f(entries[i])) {
+        std::rotate(entries.begin(), entries.begin() + i, entries.begin() + i + 1);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // insert as the most recent permutation, evicting the least recent one when full
+  constexpr void add(const permutation_t<N> &p) {
+    if constexpr (Capacity > 0) {
+      if (length < Capacity) {
+        ++length;
+      }
+      std::copy_backward(entries.begin(), entries.begin() + length - 1,
+                         entries.begin() + length);
+      entries[0] = p;
+    }
+  }
+
+  [[nodiscard]] constexpr const permutation_t<N> &at(const std::size_t i) const {
+    return entries.at(i);
+  }
+};
+
 template <uint8_t N> std::string to_string(permutation_t<N> p) {
   std::stringstream ss{};
   ss << "(";
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "concepts.h"
+#include "io.h"
+
+namespace sortnet::segment {
+// Every segment file starts with a fixed size header, followed by its records.
+// Trivially copyable records are stored as their object representation, such
+// that a whole segment is read or written with a single call and record i is
+// found at offset<T>(i). Other records are serialized one by one through their
+// read/write methods, and have a record size of VariableSize.
+//
+// The header of a segment of sets also summarizes the metadata of its sets,
+// such that two segments can be ruled out for pruning without reading them.
+constexpr uint32_t Magic{0x47534e53};  // "SNSG"
+constexpr uint16_t Version{2};
+constexpr uint32_t VariableSize{0};
+
+// sequences are 16 bits wide, so a set has at most 15 metadata channels
+constexpr std::size_t MaxChannels{16};
+
+// the bounds of the set sizes and of each metadata channel over the sets of a
+// segment, see summarize
+struct Summary {
+  uint32_t minSize{0};
+  uint32_t maxSize{0};
+  std::array<uint16_t, MaxChannels> minSizes{};
+  std::array<uint16_t, MaxChannels> maxSizes{};
+  std::array<uint8_t, MaxChannels> minOnes{};
+  std::array<uint8_t, MaxChannels> maxOnes{};
+  std::array<uint8_t, MaxChannels> minZeros{};
+  std::array<uint8_t, MaxChannels> maxZeros{};
+};
+
+struct Header {
+  uint32_t magic{Magic};
+  uint16_t version{Version};
+  uint8_t n{0};
+  uint8_t k{0};
+  uint8_t layer{0};
+  uint8_t summarized{0};  // whether summary holds the bounds of the sets
+  uint8_t reserved[2]{};
+  uint32_t count{0};
+  uint32_t recordSize{VariableSize};
+  uint32_t reserved2{0};
+  Summary summary{};
+};
+// keeps the records that follow aligned when a segment is mapped
+static_assert(sizeof(Header) % 8 == 0);
+
+template <typename T> constexpr uint32_t recordSize() {
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    return sizeof(T);
+  } else {
+    return VariableSize;
+  }
+}
+
+template <typename T> constexpr std::size_t offset(const std::size_t i) {
+  static_assert(recordSize<T>() != VariableSize, "records of variable size have no fixed offset");
+  return sizeof(Header) + i * sizeof(T);
+}
+
+template <uint8_t N, uint8_t K, typename T>
+constexpr Header header(const uint8_t layer, const uint32_t count) {
+  Header h{};
+  h.n = N;
+  h.k = K;
+  h.layer = layer;
+  h.count = count;
+  h.recordSize = recordSize<T>();
+  return h;
+}
+
+template <typename II> Summary summarize(II begin, const II end) {
+  using T = std::iter_value_t<II>;
+  constexpr std::size_t channels{decltype(T::metadata)::size};
+  static_assert(channels <= MaxChannels);
+
+  Summary summary{};
+  if (begin == end) {
+    return summary;
+  }
+  summary.minSize = UINT32_MAX;
+  summary.minSizes.fill(UINT16_MAX);
+  summary.minOnes.fill(UINT8_MAX);
+  summary.minZeros.fill(UINT8_MAX);
+  for (; begin != end; ++begin) {
+    const T &set{*begin};
+    const auto &meta{set.metadata};
+    const auto size{static_cast<uint32_t>(set.size())};
+    summary.minSize = std::min(summary.minSize, size);
+    summary.maxSize = std::max(summary.maxSize, size);
+    for (std::size_t c{0}; c < channels; ++c) {
+      const auto sizes{static_cast<uint16_t>(meta.sizes[c])};
+      const auto ones{static_cast<uint8_t>(meta.onesCount[c])};
+      const auto zeros{static_cast<uint8_t>(meta.zerosCount[c])};
+      summary.minSizes[c] = std::min(summary.minSizes[c], sizes);
+      summary.maxSizes[c] = std::max(summary.maxSizes[c], sizes);
+      summary.minOnes[c] = std::min(summary.minOnes[c], ones);
+      summary.maxOnes[c] = std::max(summary.maxOnes[c], ones);
+      summary.minZeros[c] = std::min(summary.minZeros[c], zeros);
+      summary.maxZeros[c] = std::max(summary.maxZeros[c], zeros);
+    }
+  }
+  return summary;
+}
+
+// the header of a segment holding the records [begin, end), which includes a
+// summary when the records are sets
+template <uint8_t N, uint8_t K, typename II, typename II2>
+Header header(const uint8_t layer, II begin, const II2 end) {
+  using T = std::iter_value_t<II>;
+  auto h{header<N, K, T>(layer, static_cast<uint32_t>(std::distance(begin, end)))};
+  if constexpr (::sortnet::concepts::Set<T>) {
+    h.summary = summarize(begin, std::next(begin, h.count));
+    h.summarized = 1;
+  }
+  return h;
+}
+
+// false when no set of segment a can subsume a set of segment b, as the
+// bounds of the segments already fail ST1, ST2 or ST3. Segments without a
+// summary are never ruled out, unless they are empty.
+template <uint8_t N> constexpr bool maySubsume(const Header &a, const Header &b) {
+  if (a.count == 0 || b.count == 0) {
+    return false;
+  }
+  if (a.summarized == 0 || b.summarized == 0) {
+    return true;
+  }
+  const auto &x{a.summary};
+  const auto &y{b.summary};
+  if (x.minSize > y.maxSize) {
+    return false;
+  }
+  for (std::size_t c{0}; c + 1 < N; ++c) {
+    if (x.minSizes[c] > y.maxSizes[c] || x.minOnes[c] > y.maxOnes[c]
+        || x.minZeros[c] > y.maxZeros[c]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// throws when the header does not describe a segment of T records for N and K
+template <uint8_t N, uint8_t K, typename T> void validate(const Header &h) {
+  if (h.magic != Magic || h.version != Version) {
+    throw std::runtime_error("not a segment file of a supported version");
+  }
+  if (h.n != N || h.k != K) {
+    throw std::runtime_error("the segment was written for another N or K");
+  }
+  if (h.recordSize != recordSize<T>()) {
+    throw std::runtime_error("the segment was written with another record layout");
+  }
+}
+
+template <uint8_t N, uint8_t K, typename T> void validate(const Header &h, const uint8_t layer) {
+  validate<N, K, T>(h);
+  if (h.layer != layer) {
+    throw std::runtime_error("the segment belongs to another layer");
+  }
+}
+
+template <uint8_t N, uint8_t K, typename II, typename II2>
+void write(std::ostream &f, const uint8_t layer, II begin, const II2 end) {
+  using T = std::iter_value_t<II>;
+  const auto h{header<N, K>(layer, begin, end)};
+  ::sortnet::binary_write(f, h);
+
+  if constexpr (recordSize<T>() != VariableSize && std::contiguous_iterator<II>) {
+    f.write(reinterpret_cast<const char *>(std::to_address(begin)),
+            static_cast<std::streamsize>(h.count * sizeof(T)));
+  } else {
+    for (; begin != end; ++begin) {
+      if constexpr (recordSize<T>() != VariableSize) {
+        ::sortnet::binary_write(f, static_cast<const T &>(*begin));
+      } else {
+        begin->write(f);
+      }
+    }
+  }
+}
+
+// reads at most std::distance(it, end) records and returns how many were read
+template <uint8_t N, uint8_t K, typename II>
+uint32_t read(std::istream &f, const uint8_t layer, II it, const II end) {
+  using T = std::iter_value_t<II>;
+  Header h{};
+  ::sortnet::binary_read(f, h);
+  validate<N, K, T>(h, layer);
+
+  const auto count{
+      static_cast<uint32_t>(std::min<std::size_t>(h.count, std::distance(it, end)))};
+  if constexpr (recordSize<T>() != VariableSize && std::contiguous_iterator<II>) {
+    f.read(reinterpret_cast<char *>(std::to_address(it)),
+           static_cast<std::streamsize>(count * sizeof(T)));
+  } else {
+    for (uint32_t i{0}; i < count; ++i, ++it) {
+      if constexpr (recordSize<T>() != VariableSize) {
+        ::sortnet::binary_read(f, *it);
+      } else {
+        it->read(f);
+      }
+    }
+  }
+  return count;
+}
+
+// a segment to be read into [begin, end) together with other segments, by a
+// storage that loads many segments in one batch. size is set to the number of
+// records read.
+template <typename II> struct Request {
+  std::string filename;
+  II begin;
+  II end;
+  uint32_t size{0};
+};
+}  // namespace sortnet::segment
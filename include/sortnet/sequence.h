@@ -45,6 +45,37 @@ template <uint8_t N> std::string to_string(sequence_t s) {
   auto bs = std::bitset<N>(s);
   return bs.to_string();
 }
+
+// 64 binary sequences in a channel major (bit sliced) layout, where bit j of
+// channel c is bit c of the j'th sequence.
+template <uint8_t N> using batch_t = std::array<uint64_t, N>;
+
+template <uint8_t N> constexpr std::size_t batches() {
+  return ((std::size_t(1) << N) + 63) / 64;
+}
+
+// the sequences [64 * b, 64 * b + 64) as a batch. For N below 6 every
+// sequence is repeated to fill up the 64 lanes.
+template <uint8_t N> constexpr batch_t<N> batch(const std::size_t b) {
+  constexpr std::array<uint64_t, 6> lanes{
+      0xAAAAAAAAAAAAAAAA, 0xCCCCCCCCCCCCCCCC, 0xF0F0F0F0F0F0F0F0,
+      0xFF00FF00FF00FF00, 0xFFFF0000FFFF0000, 0xFFFFFFFF00000000,
+  };
+  batch_t<N> channels{};
+  for (uint8_t c{0}; c < N; ++c) {
+    channels[c] = c < 6 ? lanes[c] : (((b >> (c - 6)) & 0b1) == 0 ? 0 : ~uint64_t(0));
+  }
+  return channels;
+}
+
+// the sequence found in lane j of a batch
+template <uint8_t N> constexpr sequence_t lane(const batch_t<N> &channels, const uint8_t j) {
+  sequence_t s{0};
+  for (uint8_t c{0}; c < N; ++c) {
+    s |= sequence_t((channels[c] >> j) & 0b1) << c;
+  }
+  return s;
+}
 }  // namespace sequence::binary
 
 // default
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <sortnet/comparator.h>
+#include <sortnet/io.h>
+#include <sortnet/kernel.h>
+#include <sortnet/sequence.h>
+#include <sortnet/sets/Metadata.h>
+#include <sortnet/z_environment.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <iterator>
+#include <type_traits>
+
+namespace sortnet::set {
+// Bitmap stores the output set as a fixed array of 2^N bits, where bit s is
+// activated when the binary sequence s is part of the set. The layout is
+// trivially copyable, so copying a set is a plain memcpy.
+template <uint8_t N, uint8_t K> class Bitmap {
+public:
+  using word_t = uint64_t;
+  static constexpr std::size_t WordBits{64};
+  static constexpr std::size_t Words{((std::size_t(1) << N) + WordBits - 1) / WordBits};
+  using words_t = std::array<word_t, Words>;
+
+private:
+  words_t words{};
+  std::size_t length{0};
+
+  // bit x of a word is activated in lanes[c] when bit c of x is
+  static constexpr std::array<word_t, 6> lanes{
+      0xAAAAAAAAAAAAAAAA, 0xCCCCCCCCCCCCCCCC, 0xF0F0F0F0F0F0F0F0,
+      0xFF00FF00FF00FF00, 0xFFFF0000FFFF0000, 0xFFFFFFFF00000000,
+  };
+
+  // partitions[k] activates every sequence with k+1 activated bits
+  static constexpr auto partitions{[]() {
+    std::array<words_t, N - 1> masks{};
+    for (std::size_t s{1}; s + 1 < (std::size_t(1) << N); ++s) {
+      masks[std::popcount(s) - 1][s / WordBits] |= word_t(1) << (s % WordBits);
+    }
+    return masks;
+  }()};
+
+  // recompute the size and the metadata per partition from the words. Channels
+  // below 6 are found within the words, the others in the word index.
+  constexpr void computeFromWords() {
+    constexpr ::sortnet::sequence_t mask{::sortnet::sequence::binary::mask<N>};
+    length = 0;
+    metadata.clear();
+    for (std::size_t k{0}; k + 1 < N; ++k) {
+      word_t any{0};
+      std::size_t size{0};
+      ::sortnet::sequence_t ones{0};
+      ::sortnet::sequence_t zeros{0};
+      for (std::size_t i{0}; i < Words; ++i) {
+        const word_t x{words[i] & partitions[k][i]};
+        if (x == 0) {
+          continue;
+        }
+        any |= x;
+        size += std::popcount(x);
+        ones |= ::sortnet::sequence_t(i) << 6;
+        zeros |= ::sortnet::sequence_t(~i) << 6;
+      }
+      if (size == 0) {
+        continue;
+      }
+
+      for (uint8_t c{0}; c < 6 && c < N; ++c) {
+        ones |= ::sortnet::sequence_t((any & lanes[c]) != 0) << c;
+        zeros |= ::sortnet::sequence_t((any & ~lanes[c]) != 0) << c;
+      }
+      length += size;
+      metadata.sizes[k] = static_cast<uint16_t>(size);
+      metadata.ones[k] = ones;
+      metadata.zeros[k] = zeros | ~mask;
+    }
+  }
+
+public:
+  Metadata<N> metadata;
+
+  constexpr Bitmap() = default;
+  constexpr Bitmap(const Bitmap &rhs) = default;
+  constexpr Bitmap &operator=(const Bitmap &rhs) = default;
+  constexpr bool operator==(const Bitmap &rhs) const {
+    if (length != rhs.length) {
+      return false;
+    }
+    return words == rhs.words;
+  }
+
+  constexpr void clear() {
+    words.fill(0);
+    length = 0;
+    metadata.clear();
+  }
+
+  [[nodiscard]] constexpr std::size_t size() const { return length; }
+
+  [[nodiscard]] constexpr bool contains(const sequence_t s) const {
+    return (words[s / WordBits] >> (s % WordBits)) & 0b1;
+  }
+
+  [[nodiscard]] constexpr bool contains([[maybe_unused]] const int8_t k,
+                                        const ::sortnet::sequence_t s) const {
+    return contains(s);
+  }
+
+  // WARNING: you can not insert a binary sequence with N activated bits,
+  // as this causes undefined behaviour.
+  constexpr void insert(const int8_t k, const ::sortnet::sequence_t s) {
+#if (PREFER_SAFETY == 1)
+    constexpr ::sortnet::sequence_t mask{::sortnet::sequence::binary::mask<N>};
+    const ::sortnet::sequence_t filtered{s & mask};
+    if (filtered == mask || filtered == 0 || filtered != s) {
+      return;
+    }
+#endif
+    word_t &w{words[s / WordBits]};
+    const word_t bit{word_t(1) << (s % WordBits)};
+    if ((w & bit) != 0) {
+      return;
+    }
+
+    w |= bit;
+    ++length;
+    metadata.compute(k, s);
+  }
+
+  // bitmaps of MinWords words or more are compared by the kernel of the
+  // processor, see kernel::Table
+  [[nodiscard]] constexpr bool subsumes(const Bitmap &other) const {
+    if (Words >= ::sortnet::kernel::Table::MinWords && !std::is_constant_evaluated()) {
+      return ::sortnet::kernel::selected().subset(words.data(), other.words.data(), Words);
+    }
+    for (std::size_t i{0}; i < Words; ++i) {
+      if ((words[i] & ~other.words[i]) != 0) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  constexpr void computeMeta() { metadata.compute(); }
+
+  // the output set after appending comparator c to the network, computed on
+  // whole words: every sequence where channel from is activated and channel
+  // to is not, moves down by 2^from - 2^to. Returns false without touching
+  // child when c moves no sequence, ie. the comparator is redundant.
+  constexpr bool apply(const ::sortnet::Comparator &c, Bitmap &child) const {
+    const uint8_t from{c.from};
+    const uint8_t to{c.to};
+
+    words_t next{words};
+    word_t moved{0};
+    if (from < 6) {
+      const word_t mask{lanes[from] & ~lanes[to]};
+      const uint8_t delta = (1 << from) - (1 << to);
+      for (word_t &w : next) {
+        const word_t m{w & mask};
+        moved |= m;
+        w = (w ^ m) | (m >> delta);
+      }
+    } else if (to < 6) {
+      const word_t mask{~lanes[to]};
+      const uint8_t delta = 1 << to;
+      const std::size_t step{std::size_t(1) << (from - 6)};
+      for (std::size_t i{step}; i < Words; ++i) {
+        if ((i & step) == 0) {
+          continue;
+        }
+        const word_t m{next[i] & mask};
+        moved |= m;
+        next[i] ^= m;
+        next[i - step] |= m << delta;
+      }
+    } else {
+      const std::size_t stepFrom{std::size_t(1) << (from - 6)};
+      const std::size_t stepTo{std::size_t(1) << (to - 6)};
+      for (std::size_t i{stepFrom}; i < Words; ++i) {
+        if ((i & stepFrom) == 0 || (i & stepTo) != 0) {
+          continue;
+        }
+        moved |= next[i];
+        next[i - stepFrom + stepTo] |= next[i];
+        next[i] = 0;
+      }
+    }
+    if (moved == 0) {
+      return false;
+    }
+
+    child.words = next;
+    child.computeFromWords();
+    return true;
+  }
+
+  [[nodiscard]] constexpr const words_t &data() const noexcept { return words; }
+
+  // iterator, walks the activated bits in ascending order
+  class const_iterator {
+  private:
+    const word_t *words{nullptr};
+    std::size_t i{Words};
+    word_t word{0};
+
+    constexpr void seek() {
+      while (word == 0 && ++i < Words) {
+        word = words[i];
+      }
+      if (word == 0) {
+        i = Words;
+      }
+    }
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = ::sortnet::sequence_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = value_type;
+
+    constexpr const_iterator() = default;
+    constexpr const_iterator(const word_t *words, const std::size_t i)
+        : words(words), i(i), word(i < Words ? words[i] : 0) {
+      seek();
+    }
+
+    constexpr value_type operator*() const {
+      return static_cast<value_type>(i * WordBits + std::countr_zero(word));
+    }
+
+    constexpr const_iterator &operator++() {
+      word &= word - 1;
+      seek();
+      return *this;
+    }
+
+    constexpr const_iterator operator++(int) {
+      const_iterator tmp{*this};
+      ++(*this);
+      return tmp;
+    }
+
+    constexpr bool operator==(const const_iterator &rhs) const {
+      return i == rhs.i && word == rhs.word;
+    }
+  };
+  [[nodiscard]] const_iterator begin() const noexcept { return const_iterator(words.data(), 0); }
+  [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+  [[nodiscard]] const_iterator end() const noexcept { return const_iterator(words.data(), Words); }
+  [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+  // file manipulation
+  void write(std::ostream &f) const {
+    metadata.write(f);
+
+    int32_t _size{static_cast<int32_t>(size())};
+    ::sortnet::binary_write(f, _size);
+    ::sortnet::binary_write(f, words);
+  }
+
+  void read(std::istream &f) {
+    clear();
+    metadata.read(f);
+
+    int32_t _size{0};
+    ::sortnet::binary_read(f, _size);
+    ::sortnet::binary_read(f, words);
+    length = static_cast<std::size_t>(_size);
+  }
+};
+}  // namespace sortnet::set
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <sortnet/io.h>
+#include <sortnet/sequence.h>
+#include <sortnet/sets/Metadata.h>
+#include <sortnet/z_environment.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace sortnet::set {
+// PartitionedVector stores the output set in one contiguous array that is
+// grouped by partition (number of activated bits) and sorted within each
+// partition. Partition k occupies [offsets[k], offsets[k+1]), such that any
+// lookup given k is a binary search over a single partition.
+template <uint8_t N, uint8_t K> class PartitionedVector {
+private:
+  static constexpr uint8_t partitions{N - 1};
+
+  std::vector<sequence_t> seqs{};
+  std::array<uint32_t, partitions + 1> offsets{};
+
+  static constexpr bool ordered(const sequence_t a, const sequence_t b) {
+    const auto ka{std::popcount(a)};
+    const auto kb{std::popcount(b)};
+    return ka == kb ? a < b : ka < kb;
+  }
+
+  using iterator = typename std::vector<::sortnet::sequence_t>::iterator;
+  [[nodiscard]] iterator partitionBegin(const int8_t k) { return seqs.begin() + offsets[k]; }
+  [[nodiscard]] iterator partitionEnd(const int8_t k) { return seqs.begin() + offsets[k + 1]; }
+
+public:
+  Metadata<N> metadata;
+
+  constexpr PartitionedVector() = default;
+  PartitionedVector(const PartitionedVector &rhs) = default;
+  PartitionedVector &operator=(const PartitionedVector &rhs) = default;
+  bool operator==(const PartitionedVector &rhs) const { return seqs == rhs.seqs; }
+
+  void clear() {
+    seqs.clear();
+    offsets.fill(0);
+    metadata.clear();
+  }
+
+  [[nodiscard]] std::size_t size() const { return seqs.size(); }
+
+  [[nodiscard]] bool contains(const sequence_t s) const {
+    return contains(static_cast<int8_t>(std::popcount(s) - 1), s);
+  }
+
+  [[nodiscard]] bool contains(const int8_t k, const ::sortnet::sequence_t s) const {
+    if (k < 0 || k >= partitions) {
+      return false;
+    }
+    return std::binary_search(cbegin(k), cend(k), s);
+  }
+
+  // WARNING: you can not insert a binary sequence with N activated bits,
+  // as this causes undefined behaviour.
+  void insert(const int8_t k, const ::sortnet::sequence_t s) {
+#if (PREFER_SAFETY == 1)
+    constexpr ::sortnet::sequence_t mask{::sortnet::sequence::binary::mask<N>};
+    const ::sortnet::sequence_t filtered{s & mask};
+    if (filtered == mask || filtered == 0) {
+      return;
+    }
+    if (std::popcount(s) - 1 != k) {
+      throw std::logic_error("sequence does not belong to the given partition");
+    }
+#endif
+    const auto end{partitionEnd(k)};
+    const auto it{std::lower_bound(partitionBegin(k), end, s)};
+    if (it != end && *it == s) {
+      return;
+    }
+
+    seqs.insert(it, s);
+    for (auto i{k + 1}; i <= partitions; ++i) {
+      ++offsets[i];
+    }
+    metadata.compute(k, s);
+  }
+
+  // every partition of this set must be included in the same partition of the other set
+  [[nodiscard]] bool subsumes(const PartitionedVector &other) const {
+    if (size() > other.size()) {
+      return false;
+    }
+    for (int8_t k{0}; k < partitions; ++k) {
+      if (!std::includes(other.cbegin(k), other.cend(k), cbegin(k), cend(k))) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  constexpr void computeMeta() { metadata.compute(); }
+
+  // iterator
+  using const_iterator = typename std::vector<::sortnet::sequence_t>::const_iterator;
+  [[nodiscard]] const_iterator begin() const noexcept { return seqs.cbegin(); }
+  [[nodiscard]] const_iterator cbegin() const noexcept { return seqs.cbegin(); }
+  [[nodiscard]] const_iterator end() const noexcept { return seqs.cend(); }
+  [[nodiscard]] const_iterator cend() const noexcept { return seqs.cend(); }
+
+  // iterate a single partition
+  [[nodiscard]] const_iterator cbegin(const int8_t k) const { return seqs.cbegin() + offsets[k]; }
+  [[nodiscard]] const_iterator cend(const int8_t k) const {
+    return seqs.cbegin() + offsets[k + 1];
+  }
+
+  // file manipulation
+  void write(std::ostream &f) const {
+    metadata.write(f);
+
+    int32_t _size{static_cast<int32_t>(size())};
+    ::sortnet::binary_write(f, _size);
+
+    for (const sequence_t s : seqs) {
+      ::sortnet::binary_write(f, s);
+    }
+  }
+
+  // the sequences are sorted into their partitions while reading, which
+  // allows loading files written by the other set implementations.
+  void read(std::istream &f) {
+    clear();
+    metadata.read(f);
+
+    int32_t _size{0};
+    ::sortnet::binary_read(f, _size);
+
+    seqs.resize(_size);
+    for (int32_t i{0}; i < _size; ++i) {
+      ::sortnet::binary_read(f, seqs[i]);
+    }
+
+    if (!std::is_sorted(seqs.cbegin(), seqs.cend(), ordered)) {
+      std::sort(seqs.begin(), seqs.end(), ordered);
+    }
+    for (const sequence_t s : seqs) {
+      ++offsets[std::popcount(s)];
+    }
+    std::partial_sum(offsets.cbegin(), offsets.cend(), offsets.begin());
+  }
+};
+}  // namespace sortnet::set
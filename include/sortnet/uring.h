@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <string>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#  define SORTNET_IO_URING 1
+#else
+#  define SORTNET_IO_URING 0
+#endif
+
+namespace sortnet::uring {
+// how a ring performs its operations. Kernels without io_uring, or without
+// plain reads and writes in it (before 5.6), and sandboxes that deny it, fall
+// back to one pread/pwrite call per operation.
+enum class Backend : uint8_t { Pread, IoUring };
+
+// a read or write of length bytes at offset in the file fd. Once the ring has
+// completed it, result holds the number of bytes transferred or -errno.
+struct Operation {
+  int fd{-1};
+  void *data{nullptr};
+  uint32_t length{0};
+  uint64_t offset{0};
+  bool write{false};
+  int64_t result{0};
+};
+
+// Ring submits batches of operations to the kernel and completes them later,
+// such that the operations of many segments are in flight at once. Short
+// transfers are resubmitted for the remainder. A ring is not thread safe.
+class Ring {
+private:
+  struct Queues;  // the submission and completion queues shared with the kernel
+
+  Backend mode{Backend::Pread};
+  int fd{-1};
+  Queues *queues{nullptr};
+
+  std::deque<Operation *> backlog{};  // not yet handed to the kernel
+  uint32_t inFlight{0};               // handed to the kernel and not yet completed
+  uint32_t unsubmitted{0};            // in the submission queue, not yet entered
+
+  bool setup(uint32_t entries);
+  void release();
+
+  // moves operations from the backlog to the submission queue while there is
+  // room for their completions, enters them and collects the completions. Waits
+  // for at least one completion if wait is set.
+  void advance(bool wait);
+
+public:
+  explicit Ring(uint32_t entries = 64, Backend preferred = Backend::IoUring);
+  Ring(const Ring &) = delete;
+  Ring &operator=(const Ring &) = delete;
+  ~Ring();
+
+  [[nodiscard]] Backend backend() const { return mode; }
+
+  // hands the operations to the kernel without waiting for any of them. The
+  // operations must stay in place until complete() returns.
+  void submit(std::span<Operation> ops);
+
+  // waits until every submitted operation has completed
+  void complete();
+
+  void run(std::span<Operation> ops) {
+    submit(ops);
+    complete();
+  }
+};
+
+std::string to_string(Backend backend);
+}  // namespace sortnet::uring
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <bit>
 #include <cmath>
@@ -90,6 +91,54 @@ template <uint8_t N> constexpr uint8_t networkSizeUpperBound() {
 
 double FloatPrecision(double v, double p);
 
+// computes the output set of a network from scratch. Every binary input except
+// 0 and 1^N is evaluated, 64 at the time using Network::runBatch.
+template <uint8_t N, concepts::ComparatorNetwork net_t, concepts::Set set_t>
+void outputSet(const net_t& net, set_t& set) {
+  constexpr std::size_t inputs{std::size_t(1) << N};
+  constexpr uint8_t lanes = inputs < 64 ? inputs : 64;
+
+  set.clear();
+  for (std::size_t b{0}; b < sequence::binary::batches<N>(); ++b) {
+    auto channels{sequence::binary::batch<N>(b)};
+    net.runBatch(channels);
+    for (uint8_t j{0}; j < lanes; ++j) {
+      const std::size_t input{b * 64 + j};
+      if (input == 0 || input == inputs - 1) {
+        continue;
+      }
+      const sequence_t s{sequence::binary::lane<N>(channels, j)};
+      set.insert(k(s), s);
+    }
+  }
+  set.computeMeta();
+}
+
+// the output set after appending comparator c to a network with the output set
+// parent. Returns false when c does not change any sequence, in which case the
+// comparator is redundant and child is left unspecified. Sets may provide a
+// faster apply member, such as the word parallel one of set::Bitmap.
+template <uint8_t N, concepts::Set set_t>
+constexpr bool applyComparator(const Comparator& c, const set_t& parent, set_t& child) {
+  if constexpr (requires { parent.apply(c, child); }) {
+    return parent.apply(c, child);
+  } else {
+    // only sequences with channel from activated and channel to deactivated change
+    const sequence_t from{sequence_t(1) << c.from};
+    const sequence_t pattern{from | (sequence_t(1) << c.to)};
+    if (std::none_of(parent.cbegin(), parent.cend(),
+                     [&](const sequence_t s) { return (s & pattern) == from; })) {
+      return false;
+    }
+
+    child.clear();
+    for (const sequence_t s : parent) {
+      child.insert(k(s), c.apply(s));
+    }
+    return true;
+  }
+}
+
 // string representation of a set with ordered partitions
 template <uint8_t N, concepts::Set set_t> std::string to_string(set_t& set) {
   std::stringstream ss{};
@@ -58,6 +58,33 @@
 #  define SEGMENT_SIZE 5000
 #endif
 // ----------------------------------------
+#ifndef PERMUTATION_CACHE_SIZE
+#  define PERMUTATION_CACHE_SIZE 16
+#endif
+// ----------------------------------------
+// pruned segments waiting to be saved, and the threads saving them
+#ifndef WRITE_BEHIND_QUEUE_SIZE
+#  define WRITE_BEHIND_QUEUE_SIZE 16
+#endif
+#ifndef WRITE_BEHIND_THREADS
+#  define WRITE_BEHIND_THREADS 1
+#endif
+// ----------------------------------------
+// bytes of segments kept in RAM by the hybrid storage
+#ifndef STORAGE_MEMORY_BUDGET
+#  define STORAGE_MEMORY_BUDGET (1ULL << 30)
+#endif
+// ----------------------------------------
+// spread the sets of each layer over its segments in ascending order of size
+#ifndef SORT_LAYERS_BY_SIZE
+#  define SORT_LAYERS_BY_SIZE 1
+#endif
+// ----------------------------------------
+// bytes of segments kept in RAM while sorting a layer or pruning across files
+#ifndef PRUNE_MEMORY_BUDGET
+#  define PRUNE_MEMORY_BUDGET (1ULL << 30)
+#endif
+// ----------------------------------------
 #if (PREFER_SAFETY == 0)
 //#define at(x) operator[](x)
 #endif
@@ -71,4 +98,9 @@ using segmentID_t = uint64_t;
 
 // custom values
 constexpr uint32_t segment_capacity{SEGMENT_SIZE};
+constexpr uint32_t permutation_cache_capacity{PERMUTATION_CACHE_SIZE};
+constexpr uint64_t storage_memory_budget{STORAGE_MEMORY_BUDGET};
+constexpr uint64_t prune_memory_budget{PRUNE_MEMORY_BUDGET};
+constexpr uint32_t write_behind_capacity{WRITE_BEHIND_QUEUE_SIZE};
+constexpr uint32_t write_behind_threads{WRITE_BEHIND_THREADS};
 }  // namespace sortnet
\ No newline at end of file
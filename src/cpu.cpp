@@ -0,0 +1,37 @@
+#include <sortnet/cpu.h>
+
+namespace sortnet::cpu {
+
+Features detect() {
+  Features features{};
+#if (SORTNET_X86_CPUID == 1)
+  __builtin_cpu_init();
+  features.avx2 = __builtin_cpu_supports("avx2");
+  features.bmi2 = __builtin_cpu_supports("bmi2");
+  features.avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+                    && __builtin_cpu_supports("avx512vl");
+#endif
+  return features;
+}
+
+Isa select(const Features &features) {
+  if (features.avx512) {
+    return Isa::AVX512;
+  }
+  if (features.avx2) {
+    return Isa::AVX2;
+  }
+  return Isa::Scalar;
+}
+
+std::string to_string(const Isa isa) {
+  switch (isa) {
+    case Isa::AVX2:
+      return "avx2";
+    case Isa::AVX512:
+      return "avx512";
+    default:
+      return "scalar";
+  }
+}
+}  // namespace sortnet::cpu
@@ -0,0 +1,435 @@
+#include <sortnet/kernel.h>
+#include <sortnet/permutation.h>
+
+#if (SORTNET_X86_CPUID == 1)
+// the AVX-512 intrinsics of GCC 12 start from an undefined register, which it
+// then reports as maybe uninitialized
+#  if !defined(__clang__)
+#    pragma GCC diagnostic push
+#    pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#  endif
+#  include <immintrin.h>
+#  if !defined(__clang__)
+#    pragma GCC diagnostic pop
+#  endif
+#endif
+
+namespace sortnet::kernel {
+namespace {
+using ::sortnet::cpu::Isa;
+using ::sortnet::permutation::detail::channelMasks;
+
+bool subsetScalar(const uint64_t *a, const uint64_t *b, const std::size_t words) {
+  for (std::size_t i{0}; i < words; ++i) {
+    if ((a[i] & ~b[i]) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool permutedSubsetScalar(uint64_t *a, const uint64_t *b, const std::size_t words,
+                          const Swap *swaps, const std::size_t count) {
+  for (std::size_t k{0}; k < count; ++k) {
+    ::sortnet::permutation::detail::swapChannels(a, words, swaps[k].a, swaps[k].b);
+  }
+  return subsetScalar(a, b, words);
+}
+
+template <typename T> bool lessEqualScalar(const T *a, const T *b, const std::size_t n) {
+  for (std::size_t i{0}; i < n; ++i) {
+    if (a[i] > b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void runBatchScalar(const ::sortnet::Comparator *comparators, const std::size_t count,
+                    uint64_t *channels, const std::size_t lanes) {
+  for (std::size_t k{0}; k < count; ++k) {
+    uint64_t *from{channels + comparators[k].from * lanes};
+    uint64_t *to{channels + comparators[k].to * lanes};
+    for (std::size_t i{0}; i < lanes; ++i) {
+      const uint64_t t{to[i]};
+      to[i] = t | from[i];
+      from[i] = t & from[i];
+    }
+  }
+}
+
+constexpr Table scalar{
+    .isa = Isa::Scalar,
+    .subset = subsetScalar,
+    .permutedSubset = permutedSubsetScalar,
+    .lessEqual8 = lessEqualScalar<uint8_t>,
+    .lessEqual16 = lessEqualScalar<uint16_t>,
+    .runBatch = runBatchScalar,
+};
+
+#if (SORTNET_X86_CPUID == 1)
+// AVX2 handles 4 words at the time. Channel swaps within a register exchange
+// the lanes step = 1 or 2 apart.
+
+[[gnu::target("avx2")]] __m256i load(const uint64_t *p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+
+[[gnu::target("avx2")]] void store(uint64_t *p, const __m256i v) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+}
+
+// the lanes of v exchanged with the lanes step apart
+[[gnu::target("avx2")]] __m256i exchange(const __m256i v, const std::size_t step) {
+  return step == 1 ? _mm256_permute4x64_epi64(v, 0xB1) : _mm256_permute4x64_epi64(v, 0x4E);
+}
+
+// the lanes of a, where those with the step bit set are taken from b
+[[gnu::target("avx2")]] __m256i blend(const __m256i a, const __m256i b, const std::size_t step) {
+  return step == 1 ? _mm256_blend_epi32(a, b, 0xCC) : _mm256_blend_epi32(a, b, 0xF0);
+}
+
+[[gnu::target("avx2")]] bool subsetAVX2(const uint64_t *a, const uint64_t *b,
+                                        const std::size_t words) {
+  std::size_t i{0};
+  for (; i + 4 <= words; i += 4) {
+    if (!_mm256_testc_si256(load(b + i), load(a + i))) {
+      return false;
+    }
+  }
+  return subsetScalar(a + i, b + i, words - i);
+}
+
+// swapChannels for a multiple of 4 words
+[[gnu::target("avx2")]] void swapAVX2(uint64_t *words, const std::size_t size, const uint8_t a,
+                                      const uint8_t b) {
+  if (b < 6) {
+    const __m128i delta{_mm_cvtsi32_si128((1 << b) - (1 << a))};
+    const __m256i mask{_mm256_set1_epi64x(channelMasks[a] & ~channelMasks[b])};
+    for (std::size_t i{0}; i < size; i += 4) {
+      const __m256i w{load(words + i)};
+      const __m256i t{_mm256_and_si256(_mm256_xor_si256(_mm256_srl_epi64(w, delta), w), mask)};
+      store(words + i, _mm256_xor_si256(w, _mm256_xor_si256(t, _mm256_sll_epi64(t, delta))));
+    }
+  } else if (a < 6) {
+    const __m128i delta{_mm_cvtsi32_si128(1 << a)};
+    const __m256i mask{_mm256_set1_epi64x(~channelMasks[a])};
+    const std::size_t step{std::size_t(1) << (b - 6)};
+    if (step >= 4) {
+      for (std::size_t lo{0}; lo + step < size; lo += 4) {
+        if ((lo & step) != 0) {
+          continue;
+        }
+        const __m256i low{load(words + lo)};
+        const __m256i high{load(words + lo + step)};
+        const __m256i t{
+            _mm256_and_si256(_mm256_xor_si256(_mm256_srl_epi64(low, delta), high), mask)};
+        store(words + lo + step, _mm256_xor_si256(high, t));
+        store(words + lo, _mm256_xor_si256(low, _mm256_sll_epi64(t, delta)));
+      }
+    } else {
+      // t is computed in the low lanes and moved to the high lanes
+      for (std::size_t i{0}; i < size; i += 4) {
+        const __m256i w{load(words + i)};
+        const __m256i t{
+            _mm256_and_si256(_mm256_xor_si256(_mm256_srl_epi64(w, delta), exchange(w, step)), mask)};
+        const __m256i low{_mm256_xor_si256(w, _mm256_sll_epi64(t, delta))};
+        const __m256i high{_mm256_xor_si256(w, exchange(t, step))};
+        store(words + i, blend(low, high, step));
+      }
+    }
+  } else {
+    const std::size_t stepA{std::size_t(1) << (a - 6)};
+    const std::size_t stepB{std::size_t(1) << (b - 6)};
+    if (stepA >= 4) {
+      for (std::size_t i{0}; i + stepB < size; i += 4) {
+        if ((i & (stepA | stepB)) == 0) {
+          const __m256i x{load(words + i + stepA)};
+          store(words + i + stepA, load(words + i + stepB));
+          store(words + i + stepB, x);
+        }
+      }
+    } else if (stepB < 4) {
+      // lane 1 and 2
+      for (std::size_t i{0}; i < size; i += 4) {
+        store(words + i, _mm256_permute4x64_epi64(load(words + i), 0xD8));
+      }
+    } else {
+      for (std::size_t i{0}; i + stepB < size; i += 4) {
+        if ((i & stepB) != 0) {
+          continue;
+        }
+        const __m256i x{load(words + i)};
+        const __m256i y{load(words + i + stepB)};
+        store(words + i, blend(x, exchange(y, stepA), stepA));
+        store(words + i + stepB, blend(exchange(x, stepA), y, stepA));
+      }
+    }
+  }
+}
+
+[[gnu::target("avx2")]] bool permutedSubsetAVX2(uint64_t *a, const uint64_t *b,
+                                                const std::size_t words, const Swap *swaps,
+                                                const std::size_t count) {
+  if (words % 4 != 0) {
+    return permutedSubsetScalar(a, b, words, swaps, count);
+  }
+  for (std::size_t k{0}; k < count; ++k) {
+    swapAVX2(a, words, swaps[k].a, swaps[k].b);
+  }
+  return subsetAVX2(a, b, words);
+}
+
+// a <= b for every lane, as a saturated a - b of zero
+[[gnu::target("avx2")]] bool lessEqual8AVX2(const uint8_t *a, const uint8_t *b,
+                                            const std::size_t n) {
+  std::size_t i{0};
+  for (; i + 8 <= n; i += 8) {
+    const __m128i x{_mm_loadl_epi64(reinterpret_cast<const __m128i *>(a + i))};
+    const __m128i y{_mm_loadl_epi64(reinterpret_cast<const __m128i *>(b + i))};
+    const __m128i d{_mm_subs_epu8(x, y)};
+    if (!_mm_testz_si128(d, d)) {
+      return false;
+    }
+  }
+  return lessEqualScalar(a + i, b + i, n - i);
+}
+
+[[gnu::target("avx2")]] bool lessEqual16AVX2(const uint16_t *a, const uint16_t *b,
+                                             const std::size_t n) {
+  std::size_t i{0};
+  for (; i + 8 <= n; i += 8) {
+    const __m128i x{_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i))};
+    const __m128i y{_mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i))};
+    const __m128i d{_mm_subs_epu16(x, y)};
+    if (!_mm_testz_si128(d, d)) {
+      return false;
+    }
+  }
+  return lessEqualScalar(a + i, b + i, n - i);
+}
+
+[[gnu::target("avx2")]] void runBatchAVX2(const ::sortnet::Comparator *comparators,
+                                          const std::size_t count, uint64_t *channels,
+                                          const std::size_t lanes) {
+  if (lanes % 4 != 0) {
+    runBatchScalar(comparators, count, channels, lanes);
+    return;
+  }
+  for (std::size_t k{0}; k < count; ++k) {
+    uint64_t *from{channels + comparators[k].from * lanes};
+    uint64_t *to{channels + comparators[k].to * lanes};
+    for (std::size_t i{0}; i < lanes; i += 4) {
+      const __m256i f{load(from + i)};
+      const __m256i t{load(to + i)};
+      store(to + i, _mm256_or_si256(t, f));
+      store(from + i, _mm256_and_si256(t, f));
+    }
+  }
+}
+
+constexpr Table avx2{
+    .isa = Isa::AVX2,
+    .subset = subsetAVX2,
+    .permutedSubset = permutedSubsetAVX2,
+    .lessEqual8 = lessEqual8AVX2,
+    .lessEqual16 = lessEqual16AVX2,
+    .runBatch = runBatchAVX2,
+};
+
+// AVX-512 handles 8 words at the time, and the tails of short arrays through
+// masked loads. Channel swaps within a register exchange the lanes step = 1,
+// 2 or 4 apart. Bitmaps of less than two registers are left to AVX2, whose
+// lane permutes are cheaper than permutexvar.
+#  define SORTNET_AVX512 "avx2,avx512f,avx512bw,avx512vl"
+
+[[gnu::target(SORTNET_AVX512)]] __m512i exchange512(const __m512i v, const std::size_t step) {
+  const __m512i lanes{_mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0)};
+  return _mm512_permutexvar_epi64(
+      _mm512_xor_si512(lanes, _mm512_set1_epi64(static_cast<int64_t>(step))), v);
+}
+
+// the lanes with the step bit set
+constexpr __mmask8 laneMask(const std::size_t step) {
+  return step == 1 ? 0xAA : (step == 2 ? 0xCC : 0xF0);
+}
+
+[[gnu::target(SORTNET_AVX512)]] bool subsetAVX512(const uint64_t *a, const uint64_t *b,
+                                                  const std::size_t words) {
+  if (words < 16) {
+    return subsetAVX2(a, b, words);
+  }
+  for (std::size_t i{0}; i < words; i += 8) {
+    const __mmask8 m{words - i >= 8 ? __mmask8(0xFF) : __mmask8((1u << (words - i)) - 1)};
+    const __m512i x{_mm512_maskz_loadu_epi64(m, a + i)};
+    const __m512i y{_mm512_maskz_loadu_epi64(m, b + i)};
+    if (_mm512_test_epi64_mask(x, _mm512_xor_si512(y, _mm512_set1_epi64(-1))) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// swapChannels for a multiple of 8 words
+[[gnu::target(SORTNET_AVX512)]] void swapAVX512(uint64_t *words, const std::size_t size,
+                                                const uint8_t a, const uint8_t b) {
+  if (b < 6) {
+    const __m128i delta{_mm_cvtsi32_si128((1 << b) - (1 << a))};
+    const __m512i mask{_mm512_set1_epi64(channelMasks[a] & ~channelMasks[b])};
+    for (std::size_t i{0}; i < size; i += 8) {
+      const __m512i w{_mm512_loadu_si512(words + i)};
+      const __m512i t{_mm512_and_si512(_mm512_xor_si512(_mm512_srl_epi64(w, delta), w), mask)};
+      _mm512_storeu_si512(words + i,
+                          _mm512_xor_si512(w, _mm512_xor_si512(t, _mm512_sll_epi64(t, delta))));
+    }
+  } else if (a < 6) {
+    const __m128i delta{_mm_cvtsi32_si128(1 << a)};
+    const __m512i mask{_mm512_set1_epi64(~channelMasks[a])};
+    const std::size_t step{std::size_t(1) << (b - 6)};
+    if (step >= 8) {
+      for (std::size_t lo{0}; lo + step < size; lo += 8) {
+        if ((lo & step) != 0) {
+          continue;
+        }
+        const __m512i low{_mm512_loadu_si512(words + lo)};
+        const __m512i high{_mm512_loadu_si512(words + lo + step)};
+        const __m512i t{
+            _mm512_and_si512(_mm512_xor_si512(_mm512_srl_epi64(low, delta), high), mask)};
+        _mm512_storeu_si512(words + lo + step, _mm512_xor_si512(high, t));
+        _mm512_storeu_si512(words + lo, _mm512_xor_si512(low, _mm512_sll_epi64(t, delta)));
+      }
+    } else {
+      // t is computed in the low lanes and moved to the high lanes
+      for (std::size_t i{0}; i < size; i += 8) {
+        const __m512i w{_mm512_loadu_si512(words + i)};
+        const __m512i t{_mm512_and_si512(
+            _mm512_xor_si512(_mm512_srl_epi64(w, delta), exchange512(w, step)), mask)};
+        const __m512i low{_mm512_xor_si512(w, _mm512_sll_epi64(t, delta))};
+        const __m512i high{_mm512_xor_si512(w, exchange512(t, step))};
+        _mm512_storeu_si512(words + i, _mm512_mask_blend_epi64(laneMask(step), low, high));
+      }
+    }
+  } else {
+    const std::size_t stepA{std::size_t(1) << (a - 6)};
+    const std::size_t stepB{std::size_t(1) << (b - 6)};
+    if (stepA >= 8) {
+      for (std::size_t i{0}; i + stepB < size; i += 8) {
+        if ((i & (stepA | stepB)) == 0) {
+          const __m512i x{_mm512_loadu_si512(words + i + stepA)};
+          _mm512_storeu_si512(words + i + stepA, _mm512_loadu_si512(words + i + stepB));
+          _mm512_storeu_si512(words + i + stepB, x);
+        }
+      }
+    } else if (stepB < 8) {
+      // lane j moves to j with both bits flipped, when exactly one is set
+      alignas(64) int64_t lanes[8]{};
+      for (std::size_t j{0}; j < 8; ++j) {
+        const bool flip{((j & stepA) != 0) != ((j & stepB) != 0)};
+        lanes[j] = static_cast<int64_t>(flip ? j ^ stepA ^ stepB : j);
+      }
+      const __m512i index{_mm512_load_si512(lanes)};
+      for (std::size_t i{0}; i < size; i += 8) {
+        _mm512_storeu_si512(words + i,
+                            _mm512_permutexvar_epi64(index, _mm512_loadu_si512(words + i)));
+      }
+    } else {
+      const __mmask8 m{laneMask(stepA)};
+      for (std::size_t i{0}; i + stepB < size; i += 8) {
+        if ((i & stepB) != 0) {
+          continue;
+        }
+        const __m512i x{_mm512_loadu_si512(words + i)};
+        const __m512i y{_mm512_loadu_si512(words + i + stepB)};
+        _mm512_storeu_si512(words + i, _mm512_mask_blend_epi64(m, x, exchange512(y, stepA)));
+        _mm512_storeu_si512(words + i + stepB,
+                            _mm512_mask_blend_epi64(m, exchange512(x, stepA), y));
+      }
+    }
+  }
+}
+
+[[gnu::target(SORTNET_AVX512)]] bool permutedSubsetAVX512(uint64_t *a, const uint64_t *b,
+                                                          const std::size_t words,
+                                                          const Swap *swaps,
+                                                          const std::size_t count) {
+  if (words % 8 != 0 || words < 16) {
+    return permutedSubsetAVX2(a, b, words, swaps, count);
+  }
+  for (std::size_t k{0}; k < count; ++k) {
+    swapAVX512(a, words, swaps[k].a, swaps[k].b);
+  }
+  return subsetAVX512(a, b, words);
+}
+
+[[gnu::target(SORTNET_AVX512)]] bool lessEqual8AVX512(const uint8_t *a, const uint8_t *b,
+                                                      const std::size_t n) {
+  for (std::size_t i{0}; i < n; i += 16) {
+    const __mmask16 m{n - i >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << (n - i)) - 1)};
+    const __m128i x{_mm_maskz_loadu_epi8(m, a + i)};
+    const __m128i y{_mm_maskz_loadu_epi8(m, b + i)};
+    if (_mm_cmpgt_epu8_mask(x, y) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+[[gnu::target(SORTNET_AVX512)]] bool lessEqual16AVX512(const uint16_t *a, const uint16_t *b,
+                                                       const std::size_t n) {
+  for (std::size_t i{0}; i < n; i += 16) {
+    const __mmask16 m{n - i >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << (n - i)) - 1)};
+    const __m256i x{_mm256_maskz_loadu_epi16(m, a + i)};
+    const __m256i y{_mm256_maskz_loadu_epi16(m, b + i)};
+    if (_mm256_cmpgt_epu16_mask(x, y) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+[[gnu::target(SORTNET_AVX512)]] void runBatchAVX512(const ::sortnet::Comparator *comparators,
+                                                    const std::size_t count, uint64_t *channels,
+                                                    const std::size_t lanes) {
+  for (std::size_t k{0}; k < count; ++k) {
+    uint64_t *from{channels + comparators[k].from * lanes};
+    uint64_t *to{channels + comparators[k].to * lanes};
+    for (std::size_t i{0}; i < lanes; i += 8) {
+      const __mmask8 m{lanes - i >= 8 ? __mmask8(0xFF) : __mmask8((1u << (lanes - i)) - 1)};
+      const __m512i f{_mm512_maskz_loadu_epi64(m, from + i)};
+      const __m512i t{_mm512_maskz_loadu_epi64(m, to + i)};
+      _mm512_mask_storeu_epi64(to + i, m, _mm512_or_si512(t, f));
+      _mm512_mask_storeu_epi64(from + i, m, _mm512_and_si512(t, f));
+    }
+  }
+}
+#  undef SORTNET_AVX512
+
+constexpr Table avx512{
+    .isa = Isa::AVX512,
+    .subset = subsetAVX512,
+    .permutedSubset = permutedSubsetAVX512,
+    .lessEqual8 = lessEqual8AVX512,
+    .lessEqual16 = lessEqual16AVX512,
+    .runBatch = runBatchAVX512,
+};
+#endif
+}  // namespace
+
+const Table &kernels(const Isa isa) {
+  switch (isa) {
+#if (SORTNET_X86_CPUID == 1)
+    case Isa::AVX512:
+      return avx512;
+    case Isa::AVX2:
+      return avx2;
+#endif
+    default:
+      return scalar;
+  }
+}
+
+const Table &selected() {
+  static const Table &table{kernels(::sortnet::cpu::select(::sortnet::cpu::detect()))};
+  return table;
+}
+}  // namespace sortnet::kernel
@@ -30,10 +30,23 @@ void MetricLayer::to_json(::nlohmann::json &j) const {
   add("redundant_comparators", RedundantComparator);
   add("redundant_comparators_quick", RedundantComparatorQuick);
   addST("st1", ST1Calls, ST1, ST1Calls - ST1);
+  j["st1"]["avoided"] = ST1Avoided;
   addST("st2", ST2Calls, ST2, ST2Calls - ST2);
   addST("st3", ST3Calls, ST3, ST3Calls - ST3);
+  addST("st4", ST4Calls, ST4, ST4Calls - ST4);
+  addST("st5", ST5Calls, ST5, ST5Calls - ST5);
   add("subsumptions", Subsumptions);
   add("permutations", Permutations);
+  add("identity_subsumptions", IdentitySubsumptions);
+  j["permutation_cache"]["hits"] = PermutationCacheHits;
+  j["permutation_cache"]["misses"] = PermutationCacheMisses;
+  j["storage"]["hits"] = StorageHits;
+  j["storage"]["misses"] = StorageMisses;
+  j["storage"]["spilled_bytes"] = StorageSpilledBytes;
+  j["segment_pairs"]["total"] = SegmentPairs;
+  j["segment_pairs"]["skipped"] = SegmentPairsSkipped;
+  j["segment_pairs"]["one_way"] = SegmentPairsOneWay;
+  j["segment_pairs"]["loads_skipped"] = SegmentLoadsSkipped;
   add("subsumes_fallback", SubsumesCalls);
 
   j["generated"]["total"] = Pruned;
@@ -0,0 +1,266 @@
+#include <sortnet/uring.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#if (SORTNET_IO_URING == 1)
+#  include <linux/io_uring.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#endif
+
+namespace sortnet::uring {
+
+#if (SORTNET_IO_URING == 1)
+struct Ring::Queues {
+  uint32_t entries{0};
+
+  void *sqRing{nullptr};
+  void *cqRing{nullptr};
+  io_uring_sqe *sqes{nullptr};
+  std::size_t sqRingSize{0};
+  std::size_t cqRingSize{0};
+  std::size_t sqesSize{0};
+
+  uint32_t *sqTail{nullptr};
+  uint32_t sqMask{0};
+  uint32_t *sqArray{nullptr};
+  uint32_t *cqHead{nullptr};
+  uint32_t *cqTail{nullptr};
+  uint32_t cqMask{0};
+  io_uring_cqe *cqes{nullptr};
+};
+
+namespace {
+template <typename T> T *at(void *ring, const uint32_t offset) {
+  return reinterpret_cast<T *>(static_cast<char *>(ring) + offset);
+}
+}  // namespace
+
+bool Ring::setup(const uint32_t entries) {
+  io_uring_params params{};
+  fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+  if (fd < 0) {
+    return false;
+  }
+
+  queues = new Queues{};
+  auto &q{*queues};
+  q.entries = params.sq_entries;
+  q.sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  q.cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  const bool single{(params.features & IORING_FEAT_SINGLE_MMAP) != 0};
+  if (single) {
+    q.sqRingSize = q.cqRingSize = std::max(q.sqRingSize, q.cqRingSize);
+  }
+
+  constexpr int Prot{PROT_READ | PROT_WRITE};
+  constexpr int Flags{MAP_SHARED | MAP_POPULATE};
+  q.sqRing = ::mmap(nullptr, q.sqRingSize, Prot, Flags, fd, IORING_OFF_SQ_RING);
+  if (q.sqRing == MAP_FAILED) {
+    q.sqRing = nullptr;
+    return false;
+  }
+  if (single) {
+    q.cqRing = q.sqRing;
+  } else {
+    q.cqRing = ::mmap(nullptr, q.cqRingSize, Prot, Flags, fd, IORING_OFF_CQ_RING);
+    if (q.cqRing == MAP_FAILED) {
+      q.cqRing = nullptr;
+      return false;
+    }
+  }
+  q.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes{::mmap(nullptr, q.sqesSize, Prot, Flags, fd, IORING_OFF_SQES)};
+  if (sqes == MAP_FAILED) {
+    return false;
+  }
+  q.sqes = static_cast<io_uring_sqe *>(sqes);
+
+  q.sqTail = at<uint32_t>(q.sqRing, params.sq_off.tail);
+  q.sqMask = *at<uint32_t>(q.sqRing, params.sq_off.ring_mask);
+  q.sqArray = at<uint32_t>(q.sqRing, params.sq_off.array);
+  q.cqHead = at<uint32_t>(q.cqRing, params.cq_off.head);
+  q.cqTail = at<uint32_t>(q.cqRing, params.cq_off.tail);
+  q.cqMask = *at<uint32_t>(q.cqRing, params.cq_off.ring_mask);
+  q.cqes = at<io_uring_cqe>(q.cqRing, params.cq_off.cqes);
+
+  // plain reads and writes came with 5.6, older kernels would only reject
+  // them once they are submitted
+#  if defined(IO_URING_OP_SUPPORTED)
+  constexpr unsigned Ops{256};
+  alignas(io_uring_probe) std::array<unsigned char,
+                                     sizeof(io_uring_probe) + Ops * sizeof(io_uring_probe_op)>
+      buffer{};
+  auto *probe{reinterpret_cast<io_uring_probe *>(buffer.data())};
+  if (::syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, Ops) < 0) {
+    return false;
+  }
+  auto supported = [&](const uint8_t op) {
+    return op <= probe->last_op && op < probe->ops_len
+           && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+  };
+  return supported(IORING_OP_READ) && supported(IORING_OP_WRITE);
+#  else
+  return false;
+#  endif
+}
+
+void Ring::release() {
+  if (queues != nullptr) {
+    auto &q{*queues};
+    if (q.sqes != nullptr) {
+      ::munmap(q.sqes, q.sqesSize);
+    }
+    if (q.cqRing != nullptr && q.cqRing != q.sqRing) {
+      ::munmap(q.cqRing, q.cqRingSize);
+    }
+    if (q.sqRing != nullptr) {
+      ::munmap(q.sqRing, q.sqRingSize);
+    }
+    delete queues;
+    queues = nullptr;
+  }
+  if (fd >= 0) {
+    ::close(fd);
+    fd = -1;
+  }
+}
+
+void Ring::advance(const bool wait) {
+  auto &q{*queues};
+  uint32_t tail{*q.sqTail};
+  while (!backlog.empty() && inFlight < q.entries) {
+    Operation &op{*backlog.front()};
+    backlog.pop_front();
+    const auto done{static_cast<uint32_t>(op.result)};
+    const uint32_t index{tail & q.sqMask};
+    io_uring_sqe &sqe{q.sqes[index]};
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = op.write ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe.fd = op.fd;
+    sqe.addr = reinterpret_cast<uint64_t>(static_cast<char *>(op.data) + done);
+    sqe.len = op.length - done;
+    sqe.off = op.offset + done;
+    sqe.user_data = reinterpret_cast<uint64_t>(&op);
+    q.sqArray[index] = index;
+    ++tail;
+    ++inFlight;
+    ++unsubmitted;
+  }
+  __atomic_store_n(q.sqTail, tail, __ATOMIC_RELEASE);
+
+  const uint32_t flags{wait ? IORING_ENTER_GETEVENTS : 0u};
+  while (true) {
+    const long r{::syscall(__NR_io_uring_enter, fd, unsubmitted, wait ? 1 : 0, flags, nullptr, 0)};
+    if (r >= 0) {
+      unsubmitted -= static_cast<uint32_t>(r);
+      break;
+    }
+    if (errno == EAGAIN || errno == EBUSY) {
+      break;  // entered again on the next call, once completions are collected
+    }
+    if (errno != EINTR) {
+      throw std::system_error(errno, std::generic_category(), "io_uring_enter");
+    }
+  }
+
+  // keep the short transfers, and drop those completed or failed
+  uint32_t head{*q.cqHead};
+  const uint32_t cqTail{__atomic_load_n(q.cqTail, __ATOMIC_ACQUIRE)};
+  for (; head != cqTail; ++head) {
+    const io_uring_cqe &cqe{q.cqes[head & q.cqMask]};
+    Operation &op{*reinterpret_cast<Operation *>(cqe.user_data)};
+    --inFlight;
+    if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+      backlog.push_back(&op);
+    } else if (cqe.res < 0) {
+      op.result = cqe.res;
+    } else if (cqe.res > 0) {
+      op.result += cqe.res;
+      if (op.result < op.length) {
+        backlog.push_back(&op);
+      }
+    }
+  }
+  __atomic_store_n(q.cqHead, head, __ATOMIC_RELEASE);
+}
+#else
+struct Ring::Queues {};
+bool Ring::setup(const uint32_t) { return false; }
+void Ring::release() {}
+void Ring::advance(const bool) {}
+#endif
+
+Ring::Ring(const uint32_t entries, const Backend preferred) {
+  if (preferred == Backend::IoUring && setup(entries)) {
+    mode = Backend::IoUring;
+  } else {
+    release();
+  }
+}
+
+Ring::~Ring() { release(); }
+
+namespace {
+// transfers the rest of an operation with plain system calls
+void transfer(Operation &op) {
+  auto done{static_cast<uint32_t>(op.result)};
+  while (done < op.length) {
+    char *data{static_cast<char *>(op.data) + done};
+    const auto r{op.write ? ::pwrite(op.fd, data, op.length - done, op.offset + done)
+                          : ::pread(op.fd, data, op.length - done, op.offset + done)};
+    if (r < 0 && errno == EINTR) {
+      continue;
+    }
+    if (r < 0) {
+      op.result = -errno;
+      return;
+    }
+    if (r == 0) {
+      break;
+    }
+    done += static_cast<uint32_t>(r);
+  }
+  op.result = done;
+}
+}  // namespace
+
+void Ring::submit(const std::span<Operation> ops) {
+  for (auto &op : ops) {
+    op.result = 0;  // the bytes transferred so far
+    backlog.push_back(&op);
+  }
+  if (mode == Backend::IoUring) {
+    advance(false);
+  }
+}
+
+void Ring::complete() {
+  if (mode == Backend::IoUring) {
+    while (inFlight > 0 || !backlog.empty()) {
+      advance(true);
+    }
+  }
+  for (Operation *op : backlog) {
+    transfer(*op);
+  }
+  backlog.clear();
+}
+
+std::string to_string(const Backend backend) {
+  switch (backend) {
+    case Backend::IoUring:
+      return "io_uring";
+    case Backend::Pread:
+    default:
+      return "pread";
+  }
+}
+}  // namespace sortnet::uring
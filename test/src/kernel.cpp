@@ -0,0 +1,170 @@
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#define UNIT_TEST 1
+
+#include <sortnet/cpu.h>
+#include <sortnet/kernel.h>
+#include <sortnet/networks/Network.h>
+#include <sortnet/permutation.h>
+
+using ::sortnet::cpu::Isa;
+
+namespace {
+// the instruction sets this processor supports, the scalar one included
+std::vector<Isa> supported() {
+  std::vector<Isa> isas{Isa::Scalar};
+  const auto best{::sortnet::cpu::select(::sortnet::cpu::detect())};
+  for (const auto isa : {Isa::AVX2, Isa::AVX512}) {
+    if (isa <= best) {
+      isas.push_back(isa);
+    }
+  }
+  return isas;
+}
+
+template <uint8_t N> void checkPermutedSubset(const ::sortnet::kernel::Table &table) {
+  constexpr std::size_t Words{((std::size_t(1) << N) + 63) / 64};
+  using words_t = std::array<uint64_t, Words>;
+  std::mt19937_64 rng{N};
+
+  for (int round{0}; round < 200; ++round) {
+    ::sortnet::permutation::permutation_t<N> p{};
+    std::iota(p.begin(), p.end(), 0);
+    std::shuffle(p.begin(), p.end(), rng);
+
+    words_t a{};
+    for (auto &w : a) {
+      w = rng() & rng();
+    }
+    words_t permuted{a};
+    ::sortnet::permutation::apply<N>(p, permuted);
+
+    // b holds the permuted a on even rounds, and misses a bit of it on odd ones
+    words_t b{};
+    for (std::size_t i{0}; i < Words; ++i) {
+      b[i] = permuted[i] | rng();
+    }
+    const bool expected{round % 2 == 0 || permuted[0] == 0};
+    if (!expected) {
+      b[0] &= ~(permuted[0] & -permuted[0]);
+    }
+
+    std::array<::sortnet::kernel::Swap, N> product{};
+    const auto count{::sortnet::permutation::swaps<N>(p, product)};
+    words_t result{a};
+    CHECK(table.permutedSubset(result.data(), b.data(), Words, product.data(), count)
+          == expected);
+    CHECK(result == permuted);
+  }
+}
+}  // namespace
+
+TEST_CASE("kernels: the selected instruction set is the most capable one") {
+  CHECK(::sortnet::cpu::select({}) == Isa::Scalar);
+  CHECK(::sortnet::cpu::select({.avx2 = true}) == Isa::AVX2);
+  CHECK(::sortnet::cpu::select({.avx2 = true, .bmi2 = true, .avx512 = true}) == Isa::AVX512);
+  CHECK(::sortnet::cpu::to_string(Isa::AVX512) == "avx512");
+
+  const auto &selected{::sortnet::kernel::selected()};
+  CHECK(selected.isa == ::sortnet::cpu::select(::sortnet::cpu::detect()));
+  CHECK(&selected == &::sortnet::kernel::kernels(selected.isa));
+}
+
+TEST_CASE("kernels: subset and less equal agree with the scalar kernels") {
+  std::mt19937_64 rng{7};
+  for (const auto isa : supported()) {
+    CAPTURE(::sortnet::cpu::to_string(isa));
+    const auto &table{::sortnet::kernel::kernels(isa)};
+
+    for (std::size_t words{1}; words <= 40; ++words) {
+      std::vector<uint64_t> a(words), b(words);
+      for (std::size_t i{0}; i < words; ++i) {
+        a[i] = rng() & rng();
+        b[i] = a[i] | rng();
+      }
+      CHECK(table.subset(a.data(), b.data(), words));
+      b[words - 1] &= ~a[words - 1] | (a[words - 1] - 1);
+      CHECK(table.subset(a.data(), b.data(), words) == (a[words - 1] == 0));
+    }
+
+    for (std::size_t n{1}; n <= 40; ++n) {
+      std::vector<uint8_t> a8(n), b8(n);
+      std::vector<uint16_t> a16(n), b16(n);
+      for (std::size_t i{0}; i < n; ++i) {
+        a8[i] = static_cast<uint8_t>(rng() % 200);
+        b8[i] = static_cast<uint8_t>(a8[i] + rng() % 50);
+        a16[i] = static_cast<uint16_t>(rng() % 60000);
+        b16[i] = static_cast<uint16_t>(a16[i] + rng() % 5000);
+      }
+      CHECK(table.lessEqual8(a8.data(), b8.data(), n));
+      CHECK(table.lessEqual16(a16.data(), b16.data(), n));
+
+      const std::size_t i{rng() % n};
+      b8[i] = a8[i] - 1 + (a8[i] == 0);
+      b16[i] = a16[i] - 1 + (a16[i] == 0);
+      CHECK(table.lessEqual8(a8.data(), b8.data(), n) == (a8[i] == 0));
+      CHECK(table.lessEqual16(a16.data(), b16.data(), n) == (a16[i] == 0));
+    }
+  }
+}
+
+TEST_CASE("kernels: permuted subsets agree with permutation::apply") {
+  for (const auto isa : supported()) {
+    CAPTURE(::sortnet::cpu::to_string(isa));
+    const auto &table{::sortnet::kernel::kernels(isa)};
+    checkPermutedSubset<7>(table);
+    checkPermutedSubset<8>(table);
+    checkPermutedSubset<9>(table);
+    checkPermutedSubset<10>(table);
+    checkPermutedSubset<11>(table);
+    checkPermutedSubset<12>(table);
+    checkPermutedSubset<13>(table);
+  }
+}
+
+TEST_CASE("kernels: run batch agrees with Network::runBatch") {
+  constexpr uint8_t N{12};
+  std::mt19937_64 rng{N};
+
+  ::sortnet::network::Network<N, 40> net{};
+  std::vector<::sortnet::Comparator> comparators{};
+  while (net.size() < 40) {
+    const auto a{static_cast<uint8_t>(rng() % N)};
+    const auto b{static_cast<uint8_t>(rng() % N)};
+    if (a != b) {
+      comparators.emplace_back(std::max(a, b), std::min(a, b));
+      net.push_back(comparators.back());
+    }
+  }
+
+  for (const auto isa : supported()) {
+    CAPTURE(::sortnet::cpu::to_string(isa));
+    const auto &table{::sortnet::kernel::kernels(isa)};
+
+    for (std::size_t lanes{1}; lanes <= 20; ++lanes) {
+      std::vector<uint64_t> channels(N * lanes);
+      for (auto &w : channels) {
+        w = rng();
+      }
+      std::vector<uint64_t> expected(channels);
+      for (std::size_t i{0}; i < lanes; ++i) {
+        std::array<uint64_t, N> lane{};
+        for (uint8_t c{0}; c < N; ++c) {
+          lane[c] = expected[c * lanes + i];
+        }
+        net.runBatch(lane);
+        for (uint8_t c{0}; c < N; ++c) {
+          expected[c * lanes + i] = lane[c];
+        }
+      }
+
+      table.runBatch(comparators.data(), comparators.size(), channels.data(), lanes);
+      CHECK(channels == expected);
+    }
+  }
+}
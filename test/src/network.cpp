@@ -1,10 +1,12 @@
 #include <doctest/doctest.h>
 
 #include <iostream>
+#include <sstream>
 #include <string>
 
 #define UNIT_TEST 1
 
+#include <sortnet/networks/Link.h>
 #include <sortnet/networks/Network.h>
 #include <sortnet/permutation.h>
 #include <sortnet/sequence.h>
@@ -111,4 +113,86 @@ TEST_CASE("serialization") {
 
   net.read(ss);
   REQUIRE(net == backup);
-}
\ No newline at end of file
+}
+TEST_CASE("run a batch of sequences") {
+  constexpr uint8_t N{7};
+  constexpr uint8_t K{20};
+  using net_t = ::sortnet::network::Network<N, K>;
+  using set_t = ::sortnet::set::ListNaive<N, K>;
+
+  net_t net{};
+  for (const auto &c : ::sortnet::comparator::all<N>) {
+    net.push_back(c);
+    if (net.size() == 12) {
+      break;
+    }
+  }
+
+  SUBCASE("every lane matches run") {
+    for (std::size_t b{0}; b < ::sortnet::sequence::binary::batches<N>(); ++b) {
+      auto channels{::sortnet::sequence::binary::batch<N>(b)};
+      for (uint8_t j{0}; j < 64; ++j) {
+        REQUIRE(::sortnet::sequence::binary::lane<N>(channels, j) == b * 64 + j);
+      }
+
+      net.runBatch(channels);
+      for (uint8_t j{0}; j < 64; ++j) {
+        REQUIRE(::sortnet::sequence::binary::lane<N>(channels, j) == net.run(b * 64 + j));
+      }
+    }
+  }
+
+  SUBCASE("output set from scratch") {
+    set_t expected{};
+    populate<N>(net, expected);
+    expected.computeMeta();
+
+    set_t set{};
+    ::sortnet::outputSet<N>(net, set);
+    REQUIRE(set.size() == expected.size());
+    for (const auto s : expected) {
+      REQUIRE(set.contains(s));
+    }
+  }
+}
+
+TEST_CASE("verify sorting networks on every input") {
+  constexpr uint8_t N{4};
+  constexpr uint8_t K{5};
+  using net_t = ::sortnet::network::Network<N, K>;
+
+  // optimal sorting network for 4 inputs
+  net_t net{};
+  net.push_back(comp<N>(0, 1));
+  net.push_back(comp<N>(2, 3));
+  net.push_back(comp<N>(0, 2));
+  net.push_back(comp<N>(1, 3));
+  REQUIRE_FALSE(net.sorts());
+
+  net.push_back(comp<N>(1, 2));
+  REQUIRE(net.sorts());
+}
+
+TEST_CASE("link records point to their parent network") {
+  constexpr uint8_t N{4};
+  constexpr uint8_t K{5};
+  using link_t = ::sortnet::network::Link<N, K>;
+
+  link_t root{};
+  root.id = 1;
+  REQUIRE(root.empty());
+
+  link_t child{root};
+  child.push_back(comp<N>(0, 1));
+  child.id = 7;
+  REQUIRE(child.parent == root.id);
+  REQUIRE(child.back() == comp<N>(0, 1));
+
+  std::stringstream stream{};
+  child.write(stream);
+  link_t read{};
+  read.read(stream);
+  REQUIRE(read.id == child.id);
+  REQUIRE(read.parent == child.parent);
+  REQUIRE(read.back() == child.back());
+}
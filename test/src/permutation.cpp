@@ -1,12 +1,17 @@
 #include <doctest/doctest.h>
 
+#include <algorithm>
 #include <bitset>
+#include <numeric>
+#include <random>
 
 #define UNIT_TEST 1
 
 #include <sortnet/networks/Network.h>
 #include <sortnet/sequence.h>
+#include <sortnet/sets/Bitmap.h>
 #include <sortnet/sets/ListNaive.h>
+#include <sortnet/util.h>
 
 #include "sortnet/permutation.h"
 #include "utilTest.h"
@@ -119,6 +124,147 @@ TEST_CASE("find permutations given constraints") {
   }
 }
 
+TEST_CASE("permutations are enumerated depth first from the highest channel") {
+  constexpr uint8_t N{5};
+
+  // same constraints as in "find permutations given constraints"
+  const std::array<sequence_t, N> constraints{0b01100, 0b11100, 0b01100, 0b00011, 0b00011};
+
+  std::vector<::sortnet::permutation::permutation_t<N>> got{};
+  ::sortnet::permutation::generate<N>(constraints, [&](const auto &p) -> bool {
+    got.push_back(p);
+    return false;
+  });
+  const std::vector<::sortnet::permutation::permutation_t<N>> wants{
+      {3, 4, 2, 1, 0},
+      {3, 4, 2, 0, 1},
+      {2, 4, 3, 1, 0},
+      {2, 4, 3, 0, 1},
+  };
+  REQUIRE(got == wants);
+}
+
+TEST_CASE("enumerate every permutation without constraints") {
+  constexpr uint8_t N{6};
+
+  ::sortnet::permutation::constraints_t<N> constraints{};
+  ::sortnet::permutation::clear<N>(constraints);
+
+  std::vector<::sortnet::permutation::permutation_t<N>> got{};
+  const bool stopped = ::sortnet::permutation::generate<N>(constraints, [&](const auto &p) {
+    got.push_back(p);
+    return false;
+  });
+  REQUIRE_FALSE(stopped);
+  REQUIRE(got.size() == ::sortnet::factorial(N));
+
+  std::sort(got.begin(), got.end());
+  REQUIRE(std::adjacent_find(got.cbegin(), got.cend()) == got.cend());
+  for (auto p : got) {
+    std::sort(p.begin(), p.end());
+    REQUIRE(p == ::sortnet::permutation::permutation_t<N>{0, 1, 2, 3, 4, 5});
+  }
+
+  SUBCASE("stops once the callback succeeds") {
+    uint64_t calls{0};
+    const bool found = ::sortnet::permutation::generate<N>(constraints, [&](const auto &) {
+      return ++calls == 10;
+    });
+    REQUIRE(found);
+    REQUIRE(calls == 10);
+  }
+}
+
+TEST_CASE("propagate forced channels") {
+  constexpr uint8_t N{5};
+
+  SUBCASE("forced channels are removed from the other rows") {
+    ::sortnet::permutation::constraints_t<N> c{0b00001, 0b00011, 0b00111, 0b11000, 0b11100};
+    REQUIRE(::sortnet::permutation::propagate<N>(c));
+    const ::sortnet::permutation::constraints_t<N> wants{0b00001, 0b00010, 0b00100,
+                                                         0b11000, 0b11000};
+    REQUIRE(c == wants);
+  }
+
+  SUBCASE("two rows forced onto the same channel") {
+    ::sortnet::permutation::constraints_t<N> c{0b00001, 0b00011, 0b00001, 0b11000, 0b11100};
+    REQUIRE_FALSE(::sortnet::permutation::propagate<N>(c));
+  }
+
+  SUBCASE("the permutations are kept") {
+    const ::sortnet::permutation::constraints_t<N> original{0b00100, 0b11100, 0b01100, 0b00011,
+                                                            0b00011};
+    auto c{original};
+    REQUIRE(::sortnet::permutation::propagate<N>(c));
+    REQUIRE(c.at(1) == 0b10000);
+    REQUIRE(c.at(2) == 0b01000);
+
+    auto collect = [](const auto &constraints) {
+      std::vector<::sortnet::permutation::permutation_t<N>> got{};
+      ::sortnet::permutation::generate<N>(constraints, [&](const auto &p) {
+        got.push_back(p);
+        return false;
+      });
+      return got;
+    };
+    REQUIRE(collect(c) == collect(original));
+  }
+}
+
+TEST_CASE("perfect matching on constraints") {
+  constexpr uint8_t N{5};
+
+  ::sortnet::permutation::constraints_t<N> c{};
+  ::sortnet::permutation::clear<N>(c);
+  REQUIRE(::sortnet::permutation::matching<N>(c));
+
+  // requires an augmenting path
+  c = {0b00011, 0b00001, 0b00110, 0b01100, 0b11000};
+  REQUIRE(::sortnet::permutation::matching<N>(c));
+
+  // three rows share two channels, but no row is a singleton
+  c = {0b00011, 0b00011, 0b00011, 0b11100, 0b11100};
+  REQUIRE(::sortnet::permutation::valid_fast<N>(c));
+  REQUIRE(::sortnet::permutation::propagate<N>(c));
+  REQUIRE_FALSE(::sortnet::permutation::matching<N>(c));
+  const bool found
+      = ::sortnet::permutation::generate<N>(c, [](const auto &) { return true; });
+  REQUIRE_FALSE(found);
+}
+
+TEST_CASE("recently used permutations") {
+  constexpr uint8_t N{4};
+  ::sortnet::permutation::Recent<N, 3> recent{};
+
+  const auto p1{perm<N>({0, 1, 2, 3})};
+  const auto p2{perm<N>({1, 0, 2, 3})};
+  const auto p3{perm<N>({2, 1, 0, 3})};
+  const auto p4{perm<N>({3, 1, 2, 0})};
+
+  REQUIRE_FALSE(recent.find([](const auto &) { return true; }));
+
+  recent.add(p1);
+  recent.add(p2);
+  recent.add(p3);
+  REQUIRE(recent.size() == 3);
+  REQUIRE(recent.at(0) == p3);
+  REQUIRE(recent.at(2) == p1);
+
+  SUBCASE("a hit becomes the most recent") {
+    REQUIRE(recent.find([&](const auto &p) { return p == p1; }));
+    REQUIRE(recent.at(0) == p1);
+    REQUIRE(recent.at(1) == p3);
+    REQUIRE(recent.at(2) == p2);
+  }
+
+  SUBCASE("the least recent is evicted") {
+    recent.add(p4);
+    REQUIRE(recent.size() == 3);
+    REQUIRE(recent.at(0) == p4);
+    REQUIRE_FALSE(recent.find([&](const auto &p) { return p == p1; }));
+  }
+}
+
 TEST_CASE("subsumes by perfect matching on partition sets") {
   constexpr uint8_t N{4};
   constexpr uint8_t K{5};
@@ -168,4 +314,99 @@ TEST_CASE("subsumes by perfect matching on partition sets") {
         return ::sortnet::permutation::subsumes<N>(p, A, B);
       });
   REQUIRE(success);
-}
\ No newline at end of file
+}
+
+TEST_CASE("early rejection agrees with testing complete permutations") {
+  constexpr uint8_t N{6};
+  constexpr uint8_t K{8};
+  using net_t = ::sortnet::network::Network<N, K>;
+  using set_t = ::sortnet::set::ListNaive<N, K>;
+
+  // output sets of a few pseudo random networks
+  std::mt19937 rng{1337};
+  const auto &comparators{::sortnet::comparator::all<N>};
+  std::vector<set_t> sets{};
+  for (auto i{0}; i < 24; ++i) {
+    net_t net{};
+    for (auto j{0}; j < 3 + i % 5; ++j) {
+      net.push_back(comparators.at(rng() % comparators.size()));
+    }
+    set_t set{};
+    populate<N>(net, set);
+    set.computeMeta();
+    sets.push_back(set);
+  }
+
+  uint64_t subsumptions{0};
+  for (const auto &A : sets) {
+    for (const auto &B : sets) {
+      ::sortnet::permutation::constraints_t<N> c{};
+      ::sortnet::permutation::clear<N>(c);
+      ::sortnet::permutation::constraints<N>(c, A, B);
+
+      const bool complete = ::sortnet::permutation::generate<N>(
+          c, [&](const auto &p) { return ::sortnet::permutation::subsumes<N>(p, A, B); });
+
+      ::sortnet::permutation::permutation_t<N> witness{};
+      const bool early = ::sortnet::permutation::subsumes<N>(c, A, B, [&](const auto &p) {
+        witness = p;
+        return true;
+      });
+
+      REQUIRE(complete == early);
+      if (early) {
+        REQUIRE(::sortnet::permutation::subsumes<N>(witness, A, B));
+        ++subsumptions;
+      }
+    }
+  }
+  REQUIRE(subsumptions > sets.size());
+}
+
+TEST_CASE("word parallel subsumption on bitmaps") {
+  constexpr uint8_t N{9};
+  constexpr uint8_t K{10};
+  using net_t = ::sortnet::network::Network<N, K>;
+  using bitmap_t = ::sortnet::set::Bitmap<N, K>;
+  using list_t = ::sortnet::set::ListNaive<N, K>;
+
+  std::mt19937 rng{7};
+  const auto &comparators{::sortnet::comparator::all<N>};
+  std::vector<bitmap_t> bitmaps{};
+  std::vector<list_t> lists{};
+  for (auto i{0}; i < 12; ++i) {
+    net_t net{};
+    for (auto j{0}; j < 4 + i % 6; ++j) {
+      net.push_back(comparators.at(rng() % comparators.size()));
+    }
+    bitmaps.emplace_back();
+    lists.emplace_back();
+    populate<N>(net, bitmaps.back());
+    populate<N>(net, lists.back());
+  }
+
+  for (auto round{0}; round < 200; ++round) {
+    ::sortnet::permutation::permutation_t<N> p{};
+    std::iota(p.begin(), p.end(), 0);
+    std::shuffle(p.begin(), p.end(), rng);
+
+    // the whole bitmap is permuted like every sequence on its own
+    const auto &A{bitmaps.at(round % bitmaps.size())};
+    auto words{A.data()};
+    ::sortnet::permutation::apply<N>(p, words);
+    bitmap_t expected{A};
+    ::sortnet::permutation::apply<N>(p, expected);
+    REQUIRE(words == expected.data());
+
+    for (std::size_t b{0}; b < bitmaps.size(); ++b) {
+      const auto a{round % bitmaps.size()};
+      REQUIRE(::sortnet::permutation::subsumes<N>(p, bitmaps[a], bitmaps[b])
+              == ::sortnet::permutation::subsumes<N>(p, lists[a], lists[b]));
+    }
+  }
+
+  // an output set subsumes itself under the identity
+  ::sortnet::permutation::permutation_t<N> identity{};
+  std::iota(identity.begin(), identity.end(), 0);
+  REQUIRE(::sortnet::permutation::subsumes<N>(identity, bitmaps[3], bitmaps[3]));
+}
@@ -0,0 +1,108 @@
+#include <doctest/doctest.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <sortnet/networks/Network.h>
+#include <sortnet/segment.h>
+#include <sortnet/sets/Bitmap.h>
+#include <sortnet/sets/ListNaive.h>
+#include <sortnet/util.h>
+
+#include "utilTest.h"
+
+TEST_CASE("segments of fixed and variable sized records") {
+  constexpr uint8_t N = 4;
+  constexpr uint8_t K = 5;
+  using bitmap_t = ::sortnet::set::Bitmap<N, K>;
+  using list_t = ::sortnet::set::ListNaive<N, K>;
+  using net_t = ::sortnet::network::Network<N, K>;
+  namespace segment = ::sortnet::segment;
+
+  static_assert(segment::recordSize<bitmap_t>() == sizeof(bitmap_t));
+  static_assert(segment::recordSize<list_t>() == segment::VariableSize);
+  static_assert(segment::offset<bitmap_t>(2) == sizeof(segment::Header) + 2 * sizeof(bitmap_t));
+
+  net_t net{};
+  net.push_back(comp<N>(0, 1));
+  net.push_back(comp<N>(2, 3));
+  std::vector<bitmap_t> bitmaps(3);
+  std::vector<list_t> lists(3);
+  for (std::size_t i{0}; i < bitmaps.size(); ++i) {
+    ::sortnet::outputSet<N>(net, bitmaps[i]);
+    ::sortnet::outputSet<N>(net, lists[i]);
+    bitmaps[i].metadata.netID = i;
+    lists[i].metadata.netID = i;
+    net.push_back(comp<N>(1, 2));
+  }
+
+  SUBCASE("fixed sized records are read back in bulk") {
+    std::stringstream ss{};
+    segment::write<N, K>(ss, 3, bitmaps.cbegin(), bitmaps.cend());
+    REQUIRE(ss.str().size() == segment::offset<bitmap_t>(bitmaps.size()));
+
+    std::vector<bitmap_t> read(5);
+    REQUIRE(segment::read<N, K>(ss, 3, read.begin(), read.end()) == 3);
+    for (std::size_t i{0}; i < bitmaps.size(); ++i) {
+      REQUIRE(read[i] == bitmaps[i]);
+      REQUIRE(read[i].metadata.netID == i);
+    }
+
+    // random access to the last record
+    bitmap_t last{};
+    ss.seekg(segment::offset<bitmap_t>(2));
+    ::sortnet::binary_read(ss, last);
+    REQUIRE(last == bitmaps[2]);
+  }
+
+  SUBCASE("variable sized records are read one by one") {
+    std::stringstream ss{};
+    segment::write<N, K>(ss, 3, lists.cbegin(), lists.cend());
+
+    std::vector<list_t> read(2);
+    REQUIRE(segment::read<N, K>(ss, 3, read.begin(), read.end()) == 2);
+    REQUIRE(read[0] == lists[0]);
+    REQUIRE(read[1] == lists[1]);
+  }
+
+  SUBCASE("segments of sets summarize their metadata in the header") {
+    std::stringstream ss{};
+    segment::write<N, K>(ss, 3, bitmaps.cbegin(), bitmaps.cend());
+    segment::Header h{};
+    ::sortnet::binary_read(ss, h);
+    REQUIRE(h.summarized == 1);
+    REQUIRE(h.summary.minSize == bitmaps[2].size());
+    REQUIRE(h.summary.maxSize == bitmaps[0].size());
+    for (std::size_t c{0}; c + 1 < N; ++c) {
+      REQUIRE(h.summary.minSizes[c] <= h.summary.maxSizes[c]);
+      REQUIRE(h.summary.maxSizes[c] == bitmaps[0].metadata.sizes[c]);
+    }
+    REQUIRE(segment::maySubsume<N>(h, h));
+
+    // the largest set can not subsume the smaller sets
+    const auto large{segment::header<N, K>(3, bitmaps.cbegin(), bitmaps.cbegin() + 1)};
+    const auto small{segment::header<N, K>(3, bitmaps.cbegin() + 1, bitmaps.cend())};
+    REQUIRE_FALSE(segment::maySubsume<N>(large, small));
+    REQUIRE(segment::maySubsume<N>(small, large));
+
+    const auto none{segment::header<N, K>(3, bitmaps.cbegin(), bitmaps.cbegin())};
+    REQUIRE_FALSE(segment::maySubsume<N>(none, large));
+  }
+
+  SUBCASE("a segment is only read for the layout it was written with") {
+    std::vector<bitmap_t> read(3);
+    std::stringstream ss{};
+    segment::write<N, K>(ss, 3, bitmaps.cbegin(), bitmaps.cend());
+    REQUIRE_THROWS_AS((segment::read<N, K>(ss, 4, read.begin(), read.end())), std::runtime_error);
+
+    ss.seekg(0);
+    REQUIRE_THROWS_AS((segment::read<N + 1, K>(ss, 3, read.begin(), read.end())),
+                      std::runtime_error);
+
+    std::vector<list_t> lists2(3);
+    ss.seekg(0);
+    REQUIRE_THROWS_AS((segment::read<N, K>(ss, 3, lists2.begin(), lists2.end())),
+                      std::runtime_error);
+  }
+}
@@ -1,6 +1,7 @@
 #include <doctest/doctest.h>
 
 #include <iostream>
+#include <random>
 #include <string>
 
 #define UNIT_TEST 1
@@ -8,7 +9,9 @@
 #include <sortnet/networks/Network.h>
 #include <sortnet/permutation.h>
 #include <sortnet/sequence.h>
+#include <sortnet/sets/Bitmap.h>
 #include <sortnet/sets/ListNaive.h>
+#include <sortnet/sets/PartitionedVector.h>
 #include <sortnet/util.h>
 #include <sortnet/z_environment.h>
 
@@ -212,4 +215,252 @@ TEST_CASE("serialization") {
 
   set1.read(ss);
   REQUIRE(set1 == set1Backup);
-}
\ No newline at end of file
+}
+
+TEST_CASE("bitmap set behaves as the list set") {
+  constexpr uint8_t N = 5;
+  constexpr uint8_t K = 5;
+  using bitmap_t = ::sortnet::set::Bitmap<N, K>;
+  using list_t = ::sortnet::set::ListNaive<N, K>;
+  using net_t = ::sortnet::network::Network<N, K>;
+
+  static_assert(std::is_trivially_copyable_v<bitmap_t>);
+
+  net_t net{};
+  net.push_back(comp<N>(1, 2));
+  net.push_back(comp<N>(3, 4));
+  net.push_back(comp<N>(1, 3));
+
+  bitmap_t bitmap{};
+  populate<N>(net, bitmap);
+  bitmap.computeMeta();
+  list_t list{};
+  populate<N>(net, list);
+  list.computeMeta();
+
+  REQUIRE(bitmap.size() == list.size());
+  for (const ::sortnet::sequence_t s : list) {
+    REQUIRE(bitmap.contains(s));
+  }
+  REQUIRE(std::size_t(std::distance(bitmap.begin(), bitmap.end())) == list.size());
+  REQUIRE(std::is_sorted(bitmap.begin(), bitmap.end()));
+
+  REQUIRE(bitmap.metadata.sizes == list.metadata.sizes);
+  REQUIRE(bitmap.metadata.ones == list.metadata.ones);
+  REQUIRE(bitmap.metadata.zeros == list.metadata.zeros);
+
+  SUBCASE("duplicates and sorted sequences are ignored") {
+    const auto size{bitmap.size()};
+    bitmap.insert(::sortnet::k(*bitmap.begin()), *bitmap.begin());
+    bitmap.insert(0, 0);
+    bitmap.insert(N - 1, ::sortnet::sequence::binary::mask<N>);
+    REQUIRE(bitmap.size() == size);
+  }
+
+  SUBCASE("subsumption") {
+    bitmap_t all{};
+    populate<N>(net_t{}, all);
+    REQUIRE(bitmap.subsumes(all));
+    REQUIRE_FALSE(all.subsumes(bitmap));
+    REQUIRE(bitmap.subsumes(bitmap));
+  }
+}
+
+TEST_CASE("bitmap set subsumes by permutation") {
+  constexpr uint8_t N = 4;
+  constexpr uint8_t K = 3;
+  using set_t = ::sortnet::set::Bitmap<N, K>;
+  using net_t = ::sortnet::network::Network<N, K>;
+
+  // same networks as in "Subsuming check"
+  net_t Ca{};
+  Ca.push_back(comp<N>(0, 1));
+  Ca.push_back(comp<N>(1, 2));
+  Ca.push_back(comp<N>(0, 3));
+
+  net_t Cb{};
+  Cb.push_back(comp<N>(0, 1));
+  Cb.push_back(comp<N>(0, 2));
+  Cb.push_back(comp<N>(1, 3));
+
+  set_t CaOutputs{};
+  populate<N>(Ca, CaOutputs);
+  set_t CbOutputs{};
+  populate<N>(Cb, CbOutputs);
+
+  auto CaOutputsStr = ::sortnet::to_string<N>(CaOutputs);
+  removeSpaces(CaOutputsStr);
+  REQUIRE(CaOutputsStr == "({0001,0010},{0011,0110},{0111,1011})");
+
+  REQUIRE_FALSE(CaOutputs.subsumes(CbOutputs));
+
+  const auto p = perm<N>({0, 1, 3, 2});
+  REQUIRE(::sortnet::permutation::subsumes<N>(p, CaOutputs, CbOutputs));
+  ::sortnet::permutation::apply<N>(p, CaOutputs);
+  REQUIRE(CaOutputs.subsumes(CbOutputs));
+}
+
+TEST_CASE("bitmap set serialization") {
+  constexpr uint8_t N = 7;
+  constexpr uint8_t K = 5;
+  using set_t = ::sortnet::set::Bitmap<N, K>;
+
+  set_t set1{};
+  for (const auto s : {0b1101, 0b1001, 0b1000000, 0b1111110, 0b0101, 0b0001}) {
+    set1.insert(::sortnet::k(s), s);
+  }
+  set1.computeMeta();
+  set_t set1Backup(set1);
+  REQUIRE(set1Backup == set1);
+
+  std::stringstream ss{};
+  set1.write(ss);
+  set1.clear();
+  REQUIRE(set1 == set_t{});
+
+  set1.read(ss);
+  REQUIRE(set1 == set1Backup);
+  REQUIRE(set1.size() == 6);
+  REQUIRE(set1.metadata.sizes == set1Backup.metadata.sizes);
+}
+
+TEST_CASE("partitioned vector set behaves as the list set") {
+  constexpr uint8_t N = 5;
+  constexpr uint8_t K = 5;
+  using vector_t = ::sortnet::set::PartitionedVector<N, K>;
+  using list_t = ::sortnet::set::ListNaive<N, K>;
+  using net_t = ::sortnet::network::Network<N, K>;
+
+  net_t net{};
+  net.push_back(comp<N>(1, 2));
+  net.push_back(comp<N>(3, 4));
+  net.push_back(comp<N>(1, 3));
+
+  vector_t vec{};
+  populate<N>(net, vec);
+  vec.computeMeta();
+  list_t list{};
+  populate<N>(net, list);
+  list.computeMeta();
+
+  REQUIRE(vec.size() == list.size());
+  for (const ::sortnet::sequence_t s : list) {
+    REQUIRE(vec.contains(s));
+    REQUIRE(vec.contains(::sortnet::k(s), s));
+    REQUIRE_FALSE(vec.contains(::sortnet::k(s) + 1, s));
+  }
+  REQUIRE(vec.metadata.sizes == list.metadata.sizes);
+  REQUIRE(vec.metadata.ones == list.metadata.ones);
+
+  SUBCASE("sequences are grouped by partition and sorted within") {
+    for (int8_t k{0}; k < N - 1; ++k) {
+      REQUIRE(std::distance(vec.cbegin(k), vec.cend(k)) == vec.metadata.sizes.at(k));
+      REQUIRE(std::is_sorted(vec.cbegin(k), vec.cend(k)));
+      for (auto it{vec.cbegin(k)}; it != vec.cend(k); ++it) {
+        REQUIRE(::sortnet::k(*it) == k);
+      }
+    }
+  }
+
+  SUBCASE("subsumption") {
+    vector_t all{};
+    populate<N>(net_t{}, all);
+    REQUIRE(vec.subsumes(all));
+    REQUIRE_FALSE(all.subsumes(vec));
+  }
+
+  SUBCASE("serialization is compatible with the list set") {
+    std::stringstream ss{};
+    list.write(ss);
+
+    vector_t vec2{};
+    vec2.read(ss);
+    REQUIRE(vec2 == vec);
+    REQUIRE(vec2.contains(*vec.cbegin(N - 2)));
+  }
+}
+
+TEST_CASE("partitioned vector set subsumes by permutation") {
+  constexpr uint8_t N = 4;
+  constexpr uint8_t K = 3;
+  using set_t = ::sortnet::set::PartitionedVector<N, K>;
+  using net_t = ::sortnet::network::Network<N, K>;
+
+  // same networks as in "Subsuming check"
+  net_t Ca{};
+  Ca.push_back(comp<N>(0, 1));
+  Ca.push_back(comp<N>(1, 2));
+  Ca.push_back(comp<N>(0, 3));
+
+  net_t Cb{};
+  Cb.push_back(comp<N>(0, 1));
+  Cb.push_back(comp<N>(0, 2));
+  Cb.push_back(comp<N>(1, 3));
+
+  set_t CaOutputs{};
+  populate<N>(Ca, CaOutputs);
+  set_t CbOutputs{};
+  populate<N>(Cb, CbOutputs);
+
+  REQUIRE_FALSE(CaOutputs.subsumes(CbOutputs));
+
+  const auto p = perm<N>({0, 1, 3, 2});
+  REQUIRE(::sortnet::permutation::subsumes<N>(p, CaOutputs, CbOutputs));
+  ::sortnet::permutation::apply<N>(p, CaOutputs);
+  REQUIRE(CaOutputs.subsumes(CbOutputs));
+}
+
+TEST_CASE("apply a comparator to a whole set") {
+  constexpr uint8_t N{9};
+  constexpr uint8_t K{12};
+  using net_t = ::sortnet::network::Network<N, K>;
+  using list_t = ::sortnet::set::ListNaive<N, K>;
+  using bitmap_t = ::sortnet::set::Bitmap<N, K>;
+  using vector_t = ::sortnet::set::PartitionedVector<N, K>;
+
+  std::mt19937 rng{9};
+  const auto &comparators{::sortnet::comparator::all<N>};
+  for (auto round{0}; round < 8; ++round) {
+    net_t net{};
+    while (net.size() < static_cast<std::size_t>(round)) {
+      net.push_back(comparators.at(rng() % comparators.size()));
+    }
+
+    list_t list{};
+    bitmap_t bitmap{};
+    vector_t vector{};
+    ::sortnet::outputSet<N>(net, list);
+    ::sortnet::outputSet<N>(net, bitmap);
+    ::sortnet::outputSet<N>(net, vector);
+
+    for (const auto &c : comparators) {
+      // output set of the child, one sequence at the time
+      list_t expected{};
+      for (const auto s : list) {
+        expected.insert(std::popcount(s) - 1, c.apply(s));
+      }
+      const bool changed{!(expected == list)};
+
+      list_t listChild{};
+      bitmap_t bitmapChild{};
+      vector_t vectorChild{};
+      REQUIRE(::sortnet::applyComparator<N>(c, list, listChild) == changed);
+      REQUIRE(::sortnet::applyComparator<N>(c, bitmap, bitmapChild) == changed);
+      REQUIRE(::sortnet::applyComparator<N>(c, vector, vectorChild) == changed);
+      if (!changed) {
+        continue;
+      }
+
+      REQUIRE(bitmapChild.size() == expected.size());
+      REQUIRE(vectorChild.size() == expected.size());
+      for (const auto s : expected) {
+        REQUIRE(listChild.contains(s));
+        REQUIRE(bitmapChild.contains(s));
+        REQUIRE(vectorChild.contains(s));
+      }
+      REQUIRE(bitmapChild.metadata.sizes == expected.metadata.sizes);
+      REQUIRE(bitmapChild.metadata.ones == expected.metadata.ones);
+      REQUIRE(bitmapChild.metadata.zeros == expected.metadata.zeros);
+    }
+  }
+}
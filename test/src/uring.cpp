@@ -0,0 +1,97 @@
+#include <doctest/doctest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <numeric>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <sortnet/uring.h>
+
+TEST_CASE("batched reads and writes through a ring") {
+  using ::sortnet::uring::Backend;
+  using ::sortnet::uring::Operation;
+
+  for (const auto preferred : {Backend::IoUring, Backend::Pread}) {
+    // the fallback is always available, io_uring only where the kernel allows it
+    ::sortnet::uring::Ring ring{4, preferred};
+    if (preferred == Backend::Pread) {
+      REQUIRE(ring.backend() == Backend::Pread);
+    }
+
+    std::array<std::string, 2> filenames{};
+    std::array<int, 2> fds{};
+    for (std::size_t i{0}; i < fds.size(); ++i) {
+      char name[] = "/tmp/sortnet-uring-XXXXXX";
+      fds[i] = ::mkstemp(name);
+      REQUIRE(fds[i] >= 0);
+      filenames[i] = name;
+    }
+
+    // more operations than the ring has entries, spread over two files
+    std::vector<uint64_t> out(3000);
+    std::iota(out.begin(), out.end(), 0);
+    constexpr uint32_t Chunk{300 * sizeof(uint64_t)};
+    std::vector<Operation> writes{};
+    for (uint32_t i{0}; i < 10; ++i) {
+      writes.push_back(Operation{
+          .fd = fds[i % 2],
+          .data = out.data() + i * 300,
+          .length = Chunk,
+          .offset = (i / 2) * Chunk,
+          .write = true,
+      });
+    }
+    ring.run(writes);
+    for (const auto& op : writes) {
+      REQUIRE(op.result == Chunk);
+    }
+
+    std::vector<uint64_t> in(out.size() + 10);
+    std::vector<Operation> reads{};
+    for (uint32_t i{0}; i < 10; ++i) {
+      reads.push_back(Operation{
+          .fd = fds[i % 2],
+          .data = in.data() + i * 300,
+          .length = Chunk,
+          .offset = (i / 2) * Chunk,
+      });
+    }
+    // reading past the end of a file stops at the end
+    reads.push_back(Operation{.fd = fds[0], .data = in.data() + 3000, .length = 80,
+                              .offset = 5 * Chunk - 8});
+    ring.run(reads);
+    for (uint32_t i{0}; i < 10; ++i) {
+      REQUIRE(reads[i].result == Chunk);
+    }
+    REQUIRE(reads.back().result == 8);
+    REQUIRE(std::equal(out.cbegin(), out.cend(), in.cbegin()));
+
+    // errors are reported per operation, and the ring keeps its backend
+    const auto backend{ring.backend()};
+    std::array<Operation, 1> invalid{{{.fd = -1, .data = in.data(), .length = 8}}};
+    ring.run(invalid);
+    REQUIRE(invalid[0].result < 0);
+    REQUIRE(ring.backend() == backend);
+
+    // batches submitted one after the other complete together
+    std::fill(in.begin(), in.end(), 0);
+    ring.submit(std::span<Operation>(reads.data(), 5));
+    ring.submit(std::span<Operation>(reads.data() + 5, 5));
+    ring.complete();
+    for (uint32_t i{0}; i < 10; ++i) {
+      REQUIRE(reads[i].result == Chunk);
+    }
+    REQUIRE(std::equal(out.cbegin(), out.cend(), in.cbegin()));
+
+    for (std::size_t i{0}; i < fds.size(); ++i) {
+      ::close(fds[i]);
+      std::remove(filenames[i].c_str());
+    }
+  }
+}
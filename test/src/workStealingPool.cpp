@@ -0,0 +1,61 @@
+#include <doctest/doctest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <vector>
+
+#include "WorkStealingPool.h"
+
+TEST_CASE("work stealing pool: jobs added from inside a job") {
+  ::sortnet::WorkStealingPool pool{3};
+  std::atomic<int> count{0};
+
+  // every job adds two more until the tree is four levels deep
+  std::function<void(int)> job{};
+  job = [&](const int depth) {
+    ++count;
+    if (depth < 4) {
+      pool.add(job, depth + 1);
+      pool.add(job, depth + 1);
+    }
+  };
+  pool.add(job, 0);
+  pool.wait();
+  CHECK(count == 31);
+}
+
+TEST_CASE("work stealing pool: wait and get run jobs on the calling thread") {
+  ::sortnet::WorkStealingPool pool{1};
+
+  // the only thread of the pool is blocked until the calling thread helps
+  std::promise<void> release{};
+  auto blocked{pool.add([released = release.get_future().share()]() { released.wait(); })};
+
+  std::vector<std::future<int>> results{};
+  for (int i{0}; i < 16; ++i) {
+    results.push_back(pool.add([i]() { return i * i; }));
+  }
+  for (int i{0}; i < 16; ++i) {
+    CHECK(pool.get(results[i]) == i * i);
+  }
+
+  pool.add([&]() { release.set_value(); });
+  pool.wait();
+  CHECK(blocked.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+}
+
+TEST_CASE("work stealing pool: the destructor drains the queues") {
+  std::atomic<int> count{0};
+  {
+    ::sortnet::WorkStealingPool pool{2};
+    for (int i{0}; i < 100; ++i) {
+      pool.add([&]() {
+        ++count;
+        pool.add([&]() { ++count; });
+      });
+    }
+  }
+  CHECK(count == 200);
+}
@@ -0,0 +1,126 @@
+#include <doctest/doctest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "WriteBehind.h"
+
+namespace {
+struct Buffer {
+  std::vector<int> sets{};
+};
+
+// counts the buffers handed back by the queue
+struct Buffers {
+  std::mutex m;
+  std::size_t returned{0};
+
+  void put(Buffer *) {
+    const std::lock_guard<std::mutex> lock(m);
+    ++returned;
+  }
+};
+
+// saves nothing until it is opened, and fails for the file "bad"
+struct Storage {
+  std::mutex m;
+  std::condition_variable opened;
+  bool open{true};
+  std::set<std::string> saved{};
+
+  template <typename II>
+  void Save(const std::string &filename, uint8_t, II, II) {
+    std::unique_lock<std::mutex> lock(m);
+    opened.wait(lock, [&]() { return open; });
+    if (filename == "bad") {
+      throw std::runtime_error("unable to save " + filename);
+    }
+    saved.insert(filename);
+  }
+
+  void set(const bool value) {
+    {
+      const std::lock_guard<std::mutex> lock(m);
+      open = value;
+    }
+    opened.notify_all();
+  }
+
+  bool contains(const std::string &filename) {
+    const std::lock_guard<std::mutex> lock(m);
+    return saved.contains(filename);
+  }
+};
+
+using Queue = ::sortnet::WriteBehind<Storage, Buffers, Buffer>;
+}  // namespace
+
+TEST_CASE("write behind: wait blocks until the file is saved") {
+  Storage storage{};
+  Buffers buffers{};
+  Buffer buffer{};
+  Queue queue{storage, buffers, 2, 4};
+
+  storage.set(false);
+  queue.save("a", 1, &buffer, 0);
+  auto waiting{std::async(std::launch::async, [&]() { queue.wait("a"); })};
+  CHECK(waiting.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout);
+  CHECK_FALSE(storage.contains("a"));
+
+  storage.set(true);
+  waiting.get();
+  CHECK(storage.contains("a"));
+
+  // a file that was never queued does not block
+  queue.wait("b");
+}
+
+TEST_CASE("write behind: flush drains the queue") {
+  Storage storage{};
+  Buffers buffers{};
+  std::vector<Buffer> buffer(8);
+  Queue queue{storage, buffers, 2, 3};
+
+  for (std::size_t i{0}; i < buffer.size(); ++i) {
+    queue.save(std::to_string(i), 1, &buffer[i], 0);
+  }
+  queue.flush();
+  for (std::size_t i{0}; i < buffer.size(); ++i) {
+    CHECK(storage.contains(std::to_string(i)));
+  }
+  CHECK(buffers.returned == buffer.size());
+}
+
+TEST_CASE("write behind: errors are rethrown") {
+  Storage storage{};
+  Buffers buffers{};
+  Buffer buffer{};
+
+  {
+    Queue queue{storage, buffers, 1, 4};
+    queue.save("bad", 1, &buffer, 0);
+    CHECK_THROWS_AS(queue.wait("bad"), std::runtime_error);
+
+    // an error is reported once, and the buffer is handed back regardless
+    queue.wait("bad");
+    CHECK(buffers.returned == 1);
+  }
+
+  {
+    // the later file is queued before the failure is known
+    Queue queue{storage, buffers, 1, 4};
+    storage.set(false);
+    queue.save("bad", 1, &buffer, 0);
+    queue.save("c", 1, &buffer, 0);
+    storage.set(true);
+    CHECK_THROWS_AS(queue.flush(), std::runtime_error);
+    CHECK(storage.contains("c"));
+  }
+}